@@ -0,0 +1,36 @@
+/* File: arena.cc
+ * --------------
+ * Implementation of the bump allocator.
+ */
+
+#include <stdlib.h>
+#include "arena.h"
+#include "utility.h"
+
+static const size_t BlockSize = 64 * 1024;
+
+thread_local Arena *Arena::current = NULL;
+
+Arena::Arena() : next(NULL), bytesLeft(0), bytesUsed(0) {}
+
+Arena::~Arena() {
+    for (int i = 0; i < blocks.size(); i++)
+        free(blocks[i]);
+}
+
+/* Called when the request does not fit in the rest of the block. A
+ * request bigger than a whole block gets a block to itself, and the
+ * current block stays in use for later small requests.
+ */
+void *Arena::AllocateBlock(size_t size) {
+    size_t blockSize = (size > BlockSize)? size : BlockSize;
+    char *block = (char *)malloc(blockSize);
+    if (!block) Failure("Out of memory!");
+    blocks.push_back(block);
+    bytesUsed += size;
+    if (blockSize == size)
+        return block;
+    next = block + size;
+    bytesLeft = blockSize - size;
+    return block;
+}
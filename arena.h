@@ -0,0 +1,74 @@
+/* File: arena.h
+ * -------------
+ * A bump allocator for everything the parser builds for one translation
+ * unit: the ast nodes, their locations and the lists that hold them.
+ * Allocation takes the next bytes of a large block, so nodes that are
+ * built together sit together in memory, and the whole tree is released
+ * at once when the arena is destroyed instead of being leaked.
+ *
+ * Each Context owns an arena and makes it the current arena for its
+ * thread while it parses; Node and List allocate from the current arena
+ * through their operator new. Nothing in an arena is destroyed one by
+ * one, and no destructors are run when it is released, so objects placed
+ * in an arena must not own memory from elsewhere.
+ */
+
+#ifndef _H_arena
+#define _H_arena
+
+#include <stddef.h>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+class Arena {
+  protected:
+    static thread_local Arena *current;
+
+    vector<char*> blocks;
+    char *next;             // first free byte in the newest block
+    size_t bytesLeft;
+    size_t bytesUsed;
+
+    void *AllocateBlock(size_t size);
+
+  public:
+    Arena();
+    ~Arena();
+
+    // Returns size bytes, aligned for any type
+    void *Allocate(size_t size) {
+        size = (size + Alignment - 1) & ~(Alignment - 1);
+        if (size > bytesLeft)
+            return AllocateBlock(size);
+        void *p = next;
+        next += size;
+        bytesLeft -= size;
+        bytesUsed += size;
+        return p;
+    }
+
+    size_t BytesUsed() const { return bytesUsed; }
+
+    static const size_t Alignment = 16;
+
+    // The arena used by Node and List on this thread, NULL for the heap
+    static Arena *Current() { return current; }
+    // Makes a the current arena and returns the one it replaces
+    static Arena *SetCurrent(Arena *a) { Arena *prev = current; current = a; return prev; }
+    static void *AllocateCurrent(size_t size)
+        { return current? current->Allocate(size) : ::operator new(size); }
+};
+
+/* Allocates from the heap for as long as it is in scope, for objects
+ * that must outlive the current arena, such as the built-in types.
+ */
+class HeapAllocation {
+    Arena *saved;
+  public:
+    HeapAllocation() : saved(Arena::SetCurrent(NULL)) {}
+    ~HeapAllocation() { Arena::SetCurrent(saved); }
+};
+
+#endif
@@ -6,43 +6,39 @@
 #include "ast_type.h"
 #include "ast_decl.h"
 #include "symtable.h"
+#include "pass.h"
 #include <string.h> // strdup
 #include <stdio.h>  // printf
 
-SymbolTable *Node::symtable = new SymbolTable();
+thread_local SymbolTable *Node::symtable = NULL;
 
 Node::Node(yyltype loc) {
-    location = new yyltype(loc);
+    location = new (Arena::AllocateCurrent(sizeof(yyltype))) yyltype(loc);
     parent = NULL;
+    nodeKind = OtherNode;
 }
 
 Node::Node() {
     location = NULL;
     parent = NULL;
+    nodeKind = OtherNode;
 }
 
 /* The Print method is used to print the parse tree nodes.
- * If this node has a location (most nodes do, but some do not), it
- * will first print the line number to help you match the parse tree 
- * back to the source text. It then indents the proper number of levels 
- * and prints the "print name" of the node. It then will invoke the
- * virtual function PrintChildren which is expected to print the
- * internals of the node (itself & children) as appropriate.
+ * It prints this node and everything below it with a PrintPass, one
+ * line per node, starting at the given indent level. See PrintPass
+ * for the format of each line.
  */
 void Node::Print(int indentLevel, const char *label) { 
-    const int numSpaces = 3;
-    printf("\n");
-    if (GetLocation()) 
-        printf("%*d", numSpaces, GetLocation()->first_line);
-    else 
-        printf("%*s", numSpaces, "");
-    printf("%*s%s%s: ", indentLevel*numSpaces, "", 
-           label? label : "", GetPrintNameForNode());
-   PrintChildren(indentLevel);
+    PrintPass printer(indentLevel);
+    PassManager passes;
+    passes.Add(&printer);
+    passes.Run(this, label);
 } 
 	 
-Identifier::Identifier(yyltype loc, const char *n) : Node(loc) {
-    name = strdup(n);
+Identifier::Identifier(yyltype loc, Atom n) : Node(loc) {
+    nodeKind = IdentifierNode;
+    name = n;
 } 
 
 void Identifier::PrintChildren(int indentLevel) {
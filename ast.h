@@ -20,17 +20,25 @@
  * set up links in both directions. The parent link is typically not used 
  * during parsing, but is more important in later phases.
  *
+ * Memory: Nodes and their locations are allocated from the current arena
+ * (see arena.h) and are released together with the translation unit, so
+ * a node is never deleted on its own.
+ *
+ * Children: Each node class lists its children, in order, by overriding
+ * GetChildren(). Passes over the tree (see pass.h) use it to walk the
+ * tree, so a node class does not implement its own traversal.
+ *
  * Printing: This functionaility is saved from pp2 of the node classes to 
- * print out the AST tree for debugging purpose.  Each node class is 
- * responsible for printing itself/children by overriding the virtual 
- * PrintChildren() and GetPrintNameForNode() methods. All the classes we 
- * provide already implement these methods, so your job is to construct the
- * nodes and wire them up during parsing. Once that's done, printing is a snap!
+ * print out the AST tree for debugging purpose.  Print() walks the tree
+ * with a PrintPass, which prints each node's GetPrintNameForNode() and
+ * the label its parent gives it. Leaf nodes print their contents (a
+ * name, a constant, an operator) by overriding PrintChildren().
 
  * Semantic analysis: For pp3 you are adding "Check" behavior to the ast
- * node classes. Your semantic analyzer should do an inorder walk on the
- * parse tree, and when visiting each node, verify the particular
- * semantic rules that apply to that construct.
+ * node classes. The CheckPass walks the parse tree and calls Check() on
+ * each node before its children, ChildChecked() on a node after each of
+ * its children, and FinishCheck() once all of them are done. Each node
+ * class verifies the semantic rules for its construct in those hooks.
 
  */
 
@@ -39,50 +47,117 @@
 
 #include <stdlib.h>   // for NULL
 #include "location.h"
+#include "atom.h"
+#include "arena.h"
+#include "list.h"
+#include "stats.h"
 #include <iostream>
+#include <vector>
 
 using namespace std;
 
 class SymbolTable;
 class MyStack;
 class FnDecl;
+class Node;
+
+// A child of a node as GetChildren() lists it, with the label it is
+// printed with, or NULL for none. A node shared by many parents, such
+// as a type, has no location of its own; the parent gives the child
+// the location of the place it appears instead.
+struct Child {
+    Node *node;
+    const char *label;
+    yyltype *location;
+};
+
+/* Each concrete node class sets its kind when it is constructed, so
+ * code that needs to know what sort of node it has can test the kind
+ * instead of trying dynamic_casts. Subclasses made for parse errors
+ * share the kind of the class they derive from.
+ */
+typedef enum {
+      OtherNode,
+      ProgramNode, IdentifierNode, ErrorNode,
+      VarDeclNode, FnDeclNode,
+      StmtBlockNode, DeclStmtNode, ForNode, WhileNode, IfNode,
+      BreakNode, ContinueNode, ReturnNode, CaseNode, DefaultNode, SwitchNode,
+      TypeNode, TypeQualifierNode, OperatorNode,
+      EmptyExprNode, IntConstantNode, FloatConstantNode, BoolConstantNode,
+      VarExprNode, ArithmeticNode, RelationalNode, EqualityNode, LogicalNode,
+      AssignNode, PostfixNode, ConditionalNode, ArrayAccessNode,
+      FieldAccessNode, CallNode
+} nodeKindT;
+
+// The expression classes are the kinds from EmptyExprNode to CallNode
+inline bool IsExprKind(nodeKindT k) { return k >= EmptyExprNode && k <= CallNode; }
 
 class Node  {
   protected:
     yyltype *location;
     Node *parent;
-    static SymbolTable *symtable;
+    nodeKindT nodeKind;
+    static thread_local SymbolTable *symtable;
 
   public:
     Node(yyltype loc);
     Node();
     virtual ~Node() {}
+
+    // Nodes made for a translation unit come from its arena; only those
+    // count as allocated, not the built-in types made on the heap
+    static void *operator new(size_t size) {
+        if (Arena::Current()) Stats::Count(Stats::NodesAllocated);
+        return Arena::AllocateCurrent(size);
+    }
+    static void operator delete(void *p)   {}
     
     yyltype *GetLocation()   { return location; }
     void SetParent(Node *p)  { parent = p; }
     Node *GetParent()        { return parent; }
+    nodeKindT GetNodeKind()  { return nodeKind; }
+
+    // The symbol table used by Check() on this thread. Each Context owns
+    // a table and installs it for the duration of its parse, so threads
+    // checking different translation units never share declarations.
+    static SymbolTable *GetSymbolTable()        { return symtable; }
+    static void SetSymbolTable(SymbolTable *st) { symtable = st; }
 
     virtual const char *GetPrintNameForNode() = 0;
+
+    // Appends the children of this node to children, in order
+    virtual void GetChildren(vector<Child> *children) {}
     
     // Print() is deliberately _not_ virtual
-    // subclasses should override PrintChildren() instead
+    // leaf subclasses should override PrintChildren() instead
     void Print(int indentLevel, const char *label = NULL); 
     virtual void PrintChildren(int indentLevel)  {}
 
 
     virtual void Check() {}
+    virtual void ChildChecked(Node *child) {}
+    virtual void FinishCheck() {}
+
+  protected:
+    // For GetChildren(); a NULL child is left out
+    static void AddChild(vector<Child> *children, Node *child, const char *label = NULL,
+                         yyltype *location = NULL)
+        { if (child) { Child c = { child, label, location }; children->push_back(c); } }
+    template <class Element>
+    static void AddChildren(vector<Child> *children, List<Element> *list, const char *label = NULL)
+        { if (list) for (Element e : *list) AddChild(children, e, label); }
 };
    
 
 class Identifier : public Node 
 {
   protected:
-    char *name;
+    Atom name;
     
   public:
-    Identifier(yyltype loc, const char *name);
+    Identifier(yyltype loc, Atom name);
     const char *GetPrintNameForNode()   { return "Identifier"; }
-    char *GetName() const { return name; }
+    Atom GetName() const { return name; }
     void PrintChildren(int indentLevel);
     friend ostream& operator<<(ostream& out, Identifier *id) { return out << id->name; }
 };
@@ -96,7 +171,7 @@ class Identifier : public Node
 class Error : public Node
 {
   public:
-    Error() : Node() {}
+    Error() : Node() { nodeKind = ErrorNode; }
     const char *GetPrintNameForNode()   { return "Error"; }
 };
 
@@ -11,16 +11,18 @@
 
 //Check function for Variable Declarations
 void VarDecl::CheckID(Identifier *id){
-  string str = string( id->GetName() );
-  scope* sc = symtable->currScope();
-  Decl *d = symtable->lookupInScope(str, sc);
+  Atom name = id->GetName();
+  scope sc = symtable->currScope();
+  Decl *d = symtable->lookupInScope(name, sc);
   //Check if variable is already present.
   if (d != NULL) {
     ReportError::DeclConflict(this, d);
   }
-  symtable->addSymbol(str, this);
+  symtable->addSymbol(name, this);
+}
 
-  //Check that types match if variable is set to something.
+//Check that types match if variable is set to something.
+void VarDecl::FinishCheck(){
   if(assignTo != NULL){
     Type *rtype = assignTo->CheckWithType();
     if(!type->IsConvertibleTo(rtype)){
@@ -38,45 +40,60 @@ Decl::Decl(Identifier *n) : Node(*n->GetLocation()) {
 }
 
 VarDecl::VarDecl(Identifier *n, Type *t, Expr *e) : Decl(n) {
+    nodeKind = VarDeclNode;
     Assert(n != NULL && t != NULL);
-    (type=t)->SetParent(this);
+    type = t;
+    assignTo = NULL;
     if (e) (assignTo=e)->SetParent(this);
     typeq = NULL;
+    typeLocation = NULL;
 }
 
 VarDecl::VarDecl(Identifier *n, TypeQualifier *tq, Expr *e) : Decl(n) {
+    nodeKind = VarDeclNode;
     Assert(n != NULL && tq != NULL);
-    (typeq=tq)->SetParent(this);
+    typeq = tq;
+    assignTo = NULL;
     if (e) (assignTo=e)->SetParent(this);
     type = NULL;
+    typeLocation = NULL;
 }
 
 VarDecl::VarDecl(Identifier *n, Type *t, TypeQualifier *tq, Expr *e) : Decl(n) {
+    nodeKind = VarDeclNode;
     Assert(n != NULL && t != NULL && tq != NULL);
-    (type=t)->SetParent(this);
-    (typeq=tq)->SetParent(this);
+    type = t;
+    typeq = tq;
+    assignTo = NULL;
     if (e) (assignTo=e)->SetParent(this);
+    typeLocation = NULL;
+}
+
+void VarDecl::SetTypeLocation(yyltype loc) {
+    typeLocation = new (Arena::AllocateCurrent(sizeof(yyltype))) yyltype(loc);
 }
   
-void VarDecl::PrintChildren(int indentLevel) { 
-   if (typeq) typeq->Print(indentLevel+1);
-   if (type) type->Print(indentLevel+1);
-   if (id) id->Print(indentLevel+1);
-   if (assignTo) assignTo->Print(indentLevel+1, "(initializer) ");
+void VarDecl::GetChildren(vector<Child> *children) { 
+   AddChild(children, typeq);
+   AddChild(children, type, NULL, typeLocation);
+   AddChild(children, id);
+   AddChild(children, assignTo, "(initializer) ");
 }
 
 FnDecl::FnDecl(Identifier *n, Type *r, List<VarDecl*> *d) : Decl(n) {
+    nodeKind = FnDeclNode;
     Assert(n != NULL && r!= NULL && d != NULL);
-    (returnType=r)->SetParent(this);
+    returnType = r;
     (formals=d)->SetParentAll(this);
     body = NULL;
     returnTypeq = NULL;
 }
 
 FnDecl::FnDecl(Identifier *n, Type *r, TypeQualifier *rq, List<VarDecl*> *d) : Decl(n) {
+    nodeKind = FnDeclNode;
     Assert(n != NULL && r != NULL && rq != NULL&& d != NULL);
-    (returnType=r)->SetParent(this);
-    (returnTypeq=rq)->SetParent(this);
+    returnType = r;
+    returnTypeq = rq;
     (formals=d)->SetParentAll(this);
     body = NULL;
 }
@@ -85,15 +102,15 @@ void FnDecl::SetFunctionBody(Stmt *b) {
     (body=b)->SetParent(this);
 }
 
-void FnDecl::PrintChildren(int indentLevel) {
-    if (returnType) returnType->Print(indentLevel+1, "(return type) ");
-    if (id) id->Print(indentLevel+1);
-    if (formals) formals->PrintAll(indentLevel+1, "(formals) ");
-    if (body) body->Print(indentLevel+1, "(body) ");
+void FnDecl::GetChildren(vector<Child> *children) {
+    AddChild(children, returnType, "(return type) ");
+    AddChild(children, id);
+    AddChildren(children, formals, "(formals) ");
+    AddChild(children, body, "(body) ");
 }
 
 void FnDecl::CheckID( Identifier *id){
-  string name = id->GetName();
+  Atom name = id->GetName();
   Decl *d = Node::symtable->lookup(name);
   if(d == NULL){
     Node::symtable->addSymbol(name, this);
@@ -102,24 +119,13 @@ void FnDecl::CheckID( Identifier *id){
     ReportError::DeclConflict(this, d);
   }
   Node::symtable->funcFlag = true;
-  //pushing new scope
-  scope s;
-  symtable->pushScope(&s);  
-
-  //adding formals into scope
-  List<VarDecl*> *formals = this->GetFormals();
-  if(formals->NumElements() > 0){
-    Decl *v = NULL;
-    for(int i = 0; i < formals->NumElements(); i++){
-      v = formals->Nth(i);
-      v->Check();
-    }
-  }
-  //need to call check on each stmt inside stmtblock
-  Stmt *stmtBody = this->body;
+  //pushing new scope; the formals and the body are checked in it
+  symtable->pushScope();  
   Node::symtable->returnType = this->returnType;
-  if(stmtBody != NULL){
-    stmtBody->Check();
+}
+
+void FnDecl::FinishCheck(){
+  if(this->body != NULL){
     if( Node::symtable->returnType != Type::voidType && Node::symtable->returnFlag == false ){
       ReportError::ReturnMissing(this);
     }
@@ -36,6 +36,8 @@ class Decl : public Node
     Identifier *GetIdentifier() const { return id; }
     friend ostream& operator<<(ostream& out, Decl *d) { return out << d->id; }
 
+  //Declares id in the current scope before the rest of the declaration
+  //is checked
   void Check() { CheckID(id); }
   virtual void CheckID(Identifier *id) {}
 
@@ -47,18 +49,24 @@ class VarDecl : public Decl
     Type *type;
     TypeQualifier *typeq;
     Expr *assignTo;
+    yyltype *typeLocation;      // where an array type is named, for printing
     
   public:
-    VarDecl() : type(NULL), typeq(NULL), assignTo(NULL) {}
+    VarDecl() : type(NULL), typeq(NULL), assignTo(NULL), typeLocation(NULL) { nodeKind = VarDeclNode; }
     VarDecl(Identifier *name, Type *type, Expr *assignTo = NULL);
     VarDecl(Identifier *name, TypeQualifier *typeq, Expr *assignTo = NULL);
     VarDecl(Identifier *name, Type *type, TypeQualifier *typeq, Expr *assignTo = NULL);
     const char *GetPrintNameForNode() { return "VarDecl"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
     Type *GetType() const { return type; }
 
+    // Types are shared between declarations and have no location of
+    // their own, so the dump shows an array type at loc
+    void SetTypeLocation(yyltype loc);
+
     //Check function
     void CheckID(Identifier *id);
+    void FinishCheck();
 };
 
 class VarDeclError : public VarDecl
@@ -77,19 +85,19 @@ class FnDecl : public Decl
     Stmt *body;
     
   public:
-    FnDecl() : Decl(), formals(NULL), returnType(NULL), returnTypeq(NULL), body(NULL) {}
+    FnDecl() : Decl(), formals(NULL), returnType(NULL), returnTypeq(NULL), body(NULL) { nodeKind = FnDeclNode; }
     FnDecl(Identifier *name, Type *returnType, List<VarDecl*> *formals);
     FnDecl(Identifier *name, Type *returnType, TypeQualifier *returnTypeq, List<VarDecl*> *formals);
     void SetFunctionBody(Stmt *b);
     const char *GetPrintNameForNode() { return "FnDecl"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
 
     Type *GetType() const { return returnType; }
     List<VarDecl*> *GetFormals() {return formals;}
 
     //Check function
     void CheckID(Identifier *id);
-    void CheckWithReturn();
+    void FinishCheck();
 };
 
 class FormalsError : public FnDecl
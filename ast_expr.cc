@@ -12,9 +12,34 @@
 
 /*** Expr Checks ***/
 
+//Types this expression and the operands it needs without recursing, so
+//that a chain of thousands of operators cannot overflow the call stack.
+//The expressions still waiting for their operands are kept on a stack
+//on the heap instead.
+void Expr::CheckOperandsFirst(){
+  vector<Expr*> pending(1, this);
+  while(!pending.empty()){
+    Expr *e = pending.back();
+    Expr *operand = e->UncheckedOperand();
+    if(operand != NULL){
+      pending.push_back(operand);
+      continue;
+    }
+    e->type = e->ComputeType();
+    e->checked = true;
+    pending.pop_back();
+  }
+}
+
+//An argument can be passed for a formal if either converts to the other
+static bool ArgumentMatches(Type *actualType, Type *formalType){
+  return actualType->IsConvertibleTo(formalType) ||
+         formalType->IsConvertibleTo(actualType);
+}
+
 //Function Call check
-Type* Call::CheckWithType(){
-  FnDecl* fDecl = (FnDecl*)Node::symtable->lookup(field->GetName());
+Type* Call::ComputeType(){
+  FnDecl* fDecl = GetDecl();
   if(fDecl == NULL){
     ReportError::NotAFunction(field);
     type = Type::errorType;
@@ -33,30 +58,43 @@ Type* Call::CheckWithType(){
     type = Type::errorType;
     return type;
   }
-  //Check arg types
-  int elems = actuals->NumElements();
-  for(int x = 0; x < elems; x++){
-    Type* actualType = actuals->Nth(x)->CheckWithType();
-    Type* formalType = fDecl->GetFormals()->Nth(x)->GetType();
-    ArrayType* arrActual = dynamic_cast<ArrayType*>(actualType);
-    ArrayType* arrFormal = dynamic_cast<ArrayType*>(formalType);
-    if(arrActual != NULL && arrFormal!= NULL){
-        actualType = arrActual->GetElemType();
-        formalType = arrFormal->GetElemType();
-    }
-    if(!actualType->IsConvertibleTo(formalType) &&
-       !formalType->IsConvertibleTo(actualType) ) {
+  //Check arg types, walking the formals alongside the actuals
+  VarDecl **formal = fDecl->GetFormals()->begin();
+  int x = 0;
+  for(Expr *actual : *actuals){
+    Type* actualType = actual->CheckWithType();
+    Type* formalType = (*formal++)->GetType();
+    if(!ArgumentMatches(actualType, formalType)) {
       ReportError::FormalsTypeMismatch(field, x+1, formalType, actualType);
       type = Type::errorType;
       return type;
     }
+    x++;
   }
   //Return return type of function
   return fDecl->GetType();
 }
 
+//The actuals are typed in order, up to the first that does not match.
+Expr* Call::UncheckedOperand(){
+  FnDecl* fDecl = GetDecl();
+  if(fDecl == NULL || actuals->NumElements() != fDecl->GetFormals()->NumElements()){
+    return NULL;
+  }
+  VarDecl **formal = fDecl->GetFormals()->begin();
+  for(Expr *actual : *actuals){
+    if(!actual->IsChecked()){
+      return actual;
+    }
+    if(!ArgumentMatches(actual->type, (*formal++)->GetType())){
+      return NULL;
+    }
+  }
+  return NULL;
+}
+
 //Field Access
-Type* FieldAccess::CheckWithType(){
+Type* FieldAccess::ComputeType(){
   //Check if called on a vec or mat type
   Type* btype = base->CheckWithType();
   if(btype == Type::mat2Type)
@@ -89,17 +127,8 @@ Type* FieldAccess::CheckWithType(){
       return type;
     }
     //Check if letters out of bounds
-    if(btype == Type::vec2Type && s[i] != 'x' && s[i] != 'y' ){
-      ReportError::SwizzleOutOfBound(field, base);
-      type = Type::errorType;
-      return type;
-    }
-    if(btype == Type::vec3Type && s[i] != 'x' && s[i] != 'y' && s[i] != 'z' ){
-      ReportError::SwizzleOutOfBound(field, base);
-      type = Type::errorType;
-      return type;
-    }
-    if(btype == Type::vec4Type && s[i] != 'x' && s[i] != 'y' && s[i] != 'z' && s[i] != 'w'){
+    int component = (s[i] == 'w')? 3 : s[i] - 'x';
+    if(btype->IsVector() && component >= btype->NumComponents()){
       ReportError::SwizzleOutOfBound(field, base);
       type = Type::errorType;
       return type;
@@ -141,37 +170,146 @@ Type* FieldAccess::CheckWithType(){
   }
 }
 
+Expr* FieldAccess::UncheckedOperand(){
+  return (base != NULL && !base->IsChecked())? base : NULL;
+}
+
 //Check Array sutff
-Type* ArrayAccess::CheckWithType(){
+Type* ArrayAccess::ComputeType(){
   VarExpr* vExpr = (VarExpr*)base;
-  ArrayType* baseType = dynamic_cast<ArrayType*>(vExpr->CheckWithType());
+  Type* btype = vExpr->CheckWithType();
   //If arrayType
-  if(baseType != NULL){
-    type = baseType->GetElemType();
+  if(btype->GetKind() == ArrayKind){
+    type = ((ArrayType*)btype)->GetElemType();
     return type;
   }
-  if(vExpr->CheckWithType()->IsMatrix() ){
-    type = vExpr->type;
+  if(btype->IsMatrix()){
+    type = btype;
     return type;
   }
-  VarExpr* vbase = (VarExpr*)base;
-  ReportError::NotAnArray(vbase->GetIdentifier());
+  ReportError::NotAnArray(vExpr->GetIdentifier());
   type = Type::errorType;
   return type;
 }
 
+Expr* ArrayAccess::UncheckedOperand(){
+  return base->IsChecked()? NULL : base;
+}
+
+/*** Operator Rules ***/
+
+/* The result of applying an operator to operands of given kinds. Which
+ * operand's type is the result matters for mixed operands: a float times
+ * a vec3 is a vec3, and so is a mat3 times a vec3. An error operand never
+ * makes a second error; the result carries on as the left operand's type,
+ * or bool for comparisons, as the checks always have.
+ */
+typedef enum {
+      Incompatible,       // report the operands, result is the error type
+      LeftResult,
+      RightResult,
+      BoolResult,
+      SameTypeBool        // bool if both are the same named or array type
+} operatorRuleT;
+
+typedef enum {
+      ArithmeticOps,      // + - / and the unary operators
+      MultiplyOps,        // * also does matrix times vector
+      RelationalOps,
+      EqualityOps,
+      LogicalOps,
+      NumOperatorGroups
+} operatorGroupT;
+
+struct OperatorRules {
+    unsigned char binary[NumOperatorGroups][NumTypeKinds][NumTypeKinds];
+    unsigned char unary[NumTypeKinds];
+};
+
+static constexpr bool IsArithmeticKind(typeKindT k) {
+    return (Type::ShapeOf(k).flags & (Type::NumericFlag | Type::VectorFlag | Type::MatrixFlag)) != 0;
+}
+
+static constexpr operatorRuleT BinaryRule(operatorGroupT g, typeKindT l, typeKindT r) {
+    const TypeShape &ls = Type::ShapeOf(l), &rs = Type::ShapeOf(r);
+    switch(g){
+    case ArithmeticOps:
+    case MultiplyOps:
+      if(l == ErrorKind || r == ErrorKind || (l == r && IsArithmeticKind(l)))
+        return LeftResult;
+      //vector or matrix with a scalar of its component kind
+      if((ls.columns * ls.rows > 1) && IsArithmeticKind(l) && r == ls.scalar)
+        return LeftResult;
+      if((rs.columns * rs.rows > 1) && IsArithmeticKind(r) && l == rs.scalar)
+        return RightResult;
+      if(g == MultiplyOps && (ls.flags & Type::MatrixFlag) &&
+         (rs.flags & Type::VectorFlag) && ls.columns == rs.rows)
+        return RightResult;
+      if(g == MultiplyOps && (ls.flags & Type::VectorFlag) &&
+         (rs.flags & Type::MatrixFlag) && ls.rows == rs.rows)
+        return LeftResult;
+      return Incompatible;
+    case RelationalOps:
+      if(!(ls.flags & (Type::NumericFlag | Type::ErrorFlag)) ||
+         !(rs.flags & (Type::NumericFlag | Type::ErrorFlag)))
+        return Incompatible;
+      return (l == r || l == ErrorKind || r == ErrorKind)? BoolResult : Incompatible;
+    case EqualityOps:
+      if(l == ErrorKind || r == ErrorKind)
+        return BoolResult;
+      if(l != r)
+        return Incompatible;
+      return (l == NamedKind || l == ArrayKind)? SameTypeBool : BoolResult;
+    case LogicalOps:
+      return ((l == BoolKind || l == ErrorKind) && (r == BoolKind || r == ErrorKind))?
+             BoolResult : Incompatible;
+    default:
+      return Incompatible;
+    }
+}
+
+static constexpr OperatorRules MakeOperatorRules() {
+    OperatorRules rules = {};
+    for(int g = 0; g < NumOperatorGroups; g++)
+      for(int l = 0; l < NumTypeKinds; l++)
+        for(int r = 0; r < NumTypeKinds; r++)
+          rules.binary[g][l][r] = BinaryRule(operatorGroupT(g), typeKindT(l), typeKindT(r));
+    for(int k = 0; k < NumTypeKinds; k++)
+      rules.unary[k] = (IsArithmeticKind(typeKindT(k)) || k == ErrorKind)? LeftResult : Incompatible;
+    return rules;
+}
+
+static constexpr OperatorRules operatorRules = MakeOperatorRules();
+
+//Returns the type of l op r, or NULL if the operands are incompatible.
+static Type *BinaryResult(operatorGroupT g, Type *l, Type *r){
+  switch(operatorRules.binary[g][l->GetKind()][r->GetKind()]){
+    case LeftResult:   return l;
+    case RightResult:  return r;
+    case BoolResult:   return Type::boolType;
+    case SameTypeBool: return (l == r)? Type::boolType : NULL;
+    default:           return NULL;
+  }
+}
+
+//Checks the operands of a binary operator and returns the result type.
+//An operand with no type, such as a conditional, gives no result.
+static Type *CheckOperands(operatorGroupT g, Operator *op, Type *l, Type *r){
+  if(l == NULL || r == NULL){
+    return Type::errorType;
+  }
+  Type *result = BinaryResult(g, l, r);
+  if(result == NULL){
+    ReportError::IncompatibleOperands(op, l, r);
+    return Type::errorType;
+  }
+  return result;
+}
+
 //Checks that it is an int or float so that it can be incremented.
-Type* PostfixExpr::CheckWithType(){
+Type* PostfixExpr::ComputeType(){
   left->CheckWithType();
-  if(left->type->Type::IsConvertibleTo(Type::intType) ||
-     left->type->Type::IsConvertibleTo(Type::floatType) ||
-     left->type->Type::IsConvertibleTo(Type::vec2Type) ||
-     left->type->Type::IsConvertibleTo(Type::vec3Type) ||
-     left->type->Type::IsConvertibleTo(Type::vec4Type) ||
-     left->type->Type::IsConvertibleTo(Type::mat2Type) ||
-     left->type->Type::IsConvertibleTo(Type::mat3Type) ||
-     left->type->Type::IsConvertibleTo(Type::mat4Type) ||
-     left->type->IsError()){
+  if(operatorRules.unary[left->type->GetKind()] == LeftResult){
     type = left->type;
     return type;
   }
@@ -180,8 +318,31 @@ Type* PostfixExpr::CheckWithType(){
   return type;
 }
 
+//The left operand, then the right; either may be missing.
+Expr* CompoundExpr::UncheckedOperand(){
+  if(left != NULL && !left->IsChecked()){
+    return left;
+  }
+  if(right != NULL && !right->IsChecked()){
+    return right;
+  }
+  return NULL;
+}
+
+//The right operand comes first, and the left is not needed if the
+//right has no type.
+Expr* ArithmeticExpr::UncheckedOperand(){
+  if(!right->IsChecked()){
+    return right;
+  }
+  if(right->type == NULL || left == NULL || left->IsChecked()){
+    return NULL;
+  }
+  return left;
+}
+
 //Same as Relational except for when left is null.
-Type* ArithmeticExpr::CheckWithType(){
+Type* ArithmeticExpr::ComputeType(){
   right->CheckWithType();
   if (right->type == NULL ){
     type = Type::errorType;
@@ -192,87 +353,30 @@ Type* ArithmeticExpr::CheckWithType(){
   }
   //One variable expr
   if(left == NULL){
-    if(right->type->Type::IsConvertibleTo(Type::intType) ||
-       right->type->Type::IsConvertibleTo(Type::floatType) ||
-       right->type->Type::IsConvertibleTo(Type::vec2Type) ||
-       right->type->Type::IsConvertibleTo(Type::vec3Type) ||
-       right->type->Type::IsConvertibleTo(Type::vec4Type) ||
-       right->type->Type::IsConvertibleTo(Type::mat2Type) ||
-       right->type->Type::IsConvertibleTo(Type::mat3Type) ||
-       right->type->Type::IsConvertibleTo(Type::mat4Type) ||
-       right->type->IsError()){
+    if(operatorRules.unary[right->type->GetKind()] == LeftResult){
       type = right->type;
       return type;
     }
-    ReportError::IncompatibleOperand(op, right->CheckWithType());
+    ReportError::IncompatibleOperand(op, right->type);
     type = Type::errorType;
     return type;
   }
   //Two variable expr
-  //One way to do it
-  if((Type::intType->IsConvertibleTo(left->type) ||
-     Type::floatType->IsConvertibleTo(left->type)) &&
-     (Type::intType->IsConvertibleTo(right->type) ||
-     Type::floatType->IsConvertibleTo(right->type))){
-     if(!left->type->Type::IsConvertibleTo(right->type) &&
-        !right->type->Type::IsConvertibleTo(left->type)){
-       ReportError::IncompatibleOperands(op, left->type, right->type);
-       type = Type::errorType;
-       return type;
-     } 
-     else {
-       type = left->type;
-       return type;
-     }
-  }
-  else if(right->type->IsError() || left->type->IsError()){
-    type = left->type;
-    return type;
-  }
-  //handling arithmetic between matrixes
-  /*else if(((right->type->Type::mat2Type) && (left->type->Type::mat2Type)) || 
-     ((right->type->Type::mat3Type) && (left->type->Type::mat3Type)) ||
-    ((right->type->Type::mat4Type) && (left->type->Type::mat4Type)) ||
-    ((right->type->Type::vec3Type) && (left->type->Type::vec3Type)) ||
-    ((right->type->Type::vec2Type) && (left->type->Type::vec2Type)) ||
-    ((right->type->Type::vec4Type) && (left->type->Type::vec4Type))){*/
-  else if(((right->type->Type::IsMatrix() && left->type->Type::IsMatrix())&&
-           (right->type->IsConvertibleTo(left->type) && (left->type->IsConvertibleTo(right->type)))) ||
-          ((right->type->Type::IsVector() && left->type->Type::IsVector()) &&
-           (right->type->IsConvertibleTo(left->type) && (left->type->IsConvertibleTo(right->type))))){
-    type = left->type;
-    return type;
-  }
-  else if(right->type->IsError() || left->type->IsError()){
-    type = left->type;
-    return type;
-  }
-  else{
-    //cout << "HI FROM ARITHMETIC ERROR FUCKER" << endl;
-    ReportError::IncompatibleOperands(op, left->type, right->type);
-    type = Type::errorType;
-    return type;
-  }
+  operatorGroupT g = op->IsOp(MulOp)? MultiplyOps : ArithmeticOps;
+  type = CheckOperands(g, op, left->type, right->type);
+  return type;
 }
 
 //Same as assignExpr, checks that types are the same.
-Type* EqualityExpr::CheckWithType(){
-  //cout << "HI FROM EQUALITY EXPR FUCKER" << endl;
+Type* EqualityExpr::ComputeType(){
   left->CheckWithType();
   right->CheckWithType();
-  if(!left->type->Type::IsConvertibleTo(right->type) &&
-     !right->type->Type::IsConvertibleTo(left->type)){
-    //cout << "EQUALITY ERROR FUCKER" << endl;
-    ReportError::IncompatibleOperands(op, left->type, right->type);
-    type = Type::errorType;
-    return type;
-  }
-  type = Type::boolType;
+  type = CheckOperands(EqualityOps, op, left->type, right->type);
   return type;
 }
 
 //Checks for incompatible types between operands.
-Type* AssignExpr::CheckWithType(){
+Type* AssignExpr::ComputeType(){
   Type *l = left->CheckWithType();
   Type *r = right->CheckWithType();
   if((!l->Type::IsConvertibleTo(r) && !r->Type::IsConvertibleTo(l))){
@@ -293,68 +397,47 @@ Type* AssignExpr::CheckWithType(){
 
 //Checks that both operands are boolean for logical expressions
 //Boolean only
-Type* LogicalExpr::CheckWithType(){
+Type* LogicalExpr::ComputeType(){
   left->CheckWithType();
   right->CheckWithType();
-  if(Type::boolType->Type::IsConvertibleTo(left->type) &&
-     Type::boolType->Type::IsConvertibleTo(right->type)){
-    type = Type::boolType;
-    return type;
-  }
-  else{
-    ReportError::IncompatibleOperands(op, left->type, right->type);
-    type = Type::errorType;
-    return type;
-  }
+  type = CheckOperands(LogicalOps, op, left->type, right->type);
+  return type;
 }
 
 //Checks that operands match for comparative expressions
 //Int or float only
-Type* RelationalExpr::CheckWithType(){
+Type* RelationalExpr::ComputeType(){
   //Force types to be set.
   left->CheckWithType();
   right->CheckWithType();
-  //One way to do it
-  if((Type::intType->Type::IsConvertibleTo(left->type) ||
-     Type::floatType->Type::IsConvertibleTo(left->type)) &&
-     (Type::intType->Type::IsConvertibleTo(right->type) ||
-     Type::floatType->Type::IsConvertibleTo(right->type)) &&
-     (left->type->Type::IsConvertibleTo(right->type) ||
-     left->type->IsError())){
-    type = Type::boolType;
-    return type;
-  }
-  else{
-    ReportError::IncompatibleOperands(op, left->type, right->type);
-    type = Type::errorType;
-    return type;
-  }
+  type = CheckOperands(RelationalOps, op, left->type, right->type);
+  return type;
 }
 
 /*** The four type setting expressions ***/
 
 //Updates expr type and returns that type.
-Type* BoolConstant::CheckWithType(){
+Type* BoolConstant::ComputeType(){
   type = Type::boolType;
   return type;
 }
 
 //Updates expr type and returns that type.
-Type* FloatConstant::CheckWithType(){
+Type* FloatConstant::ComputeType(){
   type = Type::floatType;
   return type;
 }
 
 //Updates expr type and returns that type.
-Type* IntConstant::CheckWithType(){
+Type* IntConstant::ComputeType(){
   type = Type::intType;
   return type;
 }
 
 //Checks if variable is in scope, if not return error and set to errorType.
-Type* VarExpr::CheckWithType(){
+Type* VarExpr::ComputeType(){
   //cout << "HI FROM VAR EXPR FUCKER" << endl;
-  VarDecl* vType = (VarDecl*)Node::symtable->lookup(id->GetName());
+  VarDecl* vType = GetDecl();
   if(vType == NULL){ 
     //cout << "HI FROM VAR EXPR ERROR FUCKER" << endl;
     ReportError::IdentifierNotDeclared(this->GetIdentifier(), reasonT(1));
@@ -367,9 +450,31 @@ Type* VarExpr::CheckWithType(){
 
 
 
+/*** Name Resolution ***/
+
+void VarExpr::Resolve(){
+  Decl *d = Node::symtable->lookup(id->GetName());
+  decl = (d != NULL && d->GetNodeKind() == VarDeclNode)? (VarDecl*)d : NULL;
+  resolved = true;
+}
+
+void Call::Resolve(){
+  Decl *d = Node::symtable->lookup(field->GetName());
+  decl = (d != NULL && d->GetNodeKind() == FnDeclNode)? (FnDecl*)d : NULL;
+  resolved = true;
+}
+
+VarDecl* FieldAccess::GetBaseDecl(){
+  if(base == NULL || base->GetNodeKind() != VarExprNode){
+    return NULL;
+  }
+  return ((VarExpr*)base)->GetDecl();
+}
+
 /*** Their Shit ***/
 
 IntConstant::IntConstant(yyltype loc, int val) : Expr(loc) {
+    nodeKind = IntConstantNode;
     value = val;
 }
 void IntConstant::PrintChildren(int indentLevel) { 
@@ -377,6 +482,7 @@ void IntConstant::PrintChildren(int indentLevel) {
 }
 
 FloatConstant::FloatConstant(yyltype loc, double val) : Expr(loc) {
+    nodeKind = FloatConstantNode;
     value = val;
 }
 void FloatConstant::PrintChildren(int indentLevel) { 
@@ -384,6 +490,7 @@ void FloatConstant::PrintChildren(int indentLevel) {
 }
 
 BoolConstant::BoolConstant(yyltype loc, bool val) : Expr(loc) {
+    nodeKind = BoolConstantNode;
     value = val;
 }
 void BoolConstant::PrintChildren(int indentLevel) { 
@@ -391,25 +498,36 @@ void BoolConstant::PrintChildren(int indentLevel) {
 }
 
 VarExpr::VarExpr(yyltype loc, Identifier *ident) : Expr(loc) {
+    nodeKind = VarExprNode;
     Assert(ident != NULL);
     this->id = ident;
+    decl = NULL;
+    resolved = false;
 }
 
-void VarExpr::PrintChildren(int indentLevel) {
-    id->Print(indentLevel+1);
+void VarExpr::GetChildren(vector<Child> *children) {
+    AddChild(children, id);
 }
 
-Operator::Operator(yyltype loc, const char *tok) : Node(loc) {
-    Assert(tok != NULL);
-    strncpy(tokenString, tok, sizeof(tokenString));
+Operator::Operator(yyltype loc, opcodeT op) : Node(loc) {
+    nodeKind = OperatorNode;
+    Assert(op >= 0 && op < NumOpcodes);
+    opcode = op;
 }
 
 void Operator::PrintChildren(int indentLevel) {
-    printf("%s",tokenString);
+    printf("%s", Spelling(opcode));
 }
 
-bool Operator::IsOp(const char *op) const {
-    return strcmp(tokenString, op) == 0;
+const char *Operator::Spelling(opcodeT op) {
+    static const char *const spellings[NumOpcodes] = {
+        "+", "-", "*", "/",
+        "++", "--",
+        "<", ">", "<=", ">=",
+        "==", "!=", "&&", "||",
+        "=", "+=", "-=", "*=", "/="
+    };
+    return spellings[op];
 }
 
 CompoundExpr::CompoundExpr(Expr *l, Operator *o, Expr *r) 
@@ -431,41 +549,45 @@ CompoundExpr::CompoundExpr(Operator *o, Expr *r)
 CompoundExpr::CompoundExpr(Expr *l, Operator *o) 
   : Expr(Join(l->GetLocation(), o->GetLocation())) {
     Assert(l != NULL && o != NULL);
+    right = NULL;
     (left=l)->SetParent(this);
     (op=o)->SetParent(this);
 }
 
-void CompoundExpr::PrintChildren(int indentLevel) {
-   if (left) left->Print(indentLevel+1);
-   op->Print(indentLevel+1);
-   if (right) right->Print(indentLevel+1);
+void CompoundExpr::GetChildren(vector<Child> *children) {
+   AddChild(children, left);
+   AddChild(children, op);
+   AddChild(children, right);
 }
    
 ConditionalExpr::ConditionalExpr(Expr *c, Expr *t, Expr *f)
   : Expr(Join(c->GetLocation(), f->GetLocation())) {
+    nodeKind = ConditionalNode;
     Assert(c != NULL && t != NULL && f != NULL);
     (cond=c)->SetParent(this);
     (trueExpr=t)->SetParent(this);
     (falseExpr=f)->SetParent(this);
 }
 
-void ConditionalExpr::PrintChildren(int indentLevel) {
-    cond->Print(indentLevel+1, "(cond) ");
-    trueExpr->Print(indentLevel+1, "(true) ");
-    falseExpr->Print(indentLevel+1, "(false) ");
+void ConditionalExpr::GetChildren(vector<Child> *children) {
+    AddChild(children, cond, "(cond) ");
+    AddChild(children, trueExpr, "(true) ");
+    AddChild(children, falseExpr, "(false) ");
 }
 ArrayAccess::ArrayAccess(yyltype loc, Expr *b, Expr *s) : LValue(loc) {
+    nodeKind = ArrayAccessNode;
     (base=b)->SetParent(this); 
     (subscript=s)->SetParent(this);
 }
 
-void ArrayAccess::PrintChildren(int indentLevel) {
-    base->Print(indentLevel+1);
-    subscript->Print(indentLevel+1, "(subscript) ");
+void ArrayAccess::GetChildren(vector<Child> *children) {
+    AddChild(children, base);
+    AddChild(children, subscript, "(subscript) ");
 }
      
 FieldAccess::FieldAccess(Expr *b, Identifier *f) 
   : LValue(b? Join(b->GetLocation(), f->GetLocation()) : *f->GetLocation()) {
+    nodeKind = FieldAccessNode;
     Assert(f != NULL); // b can be be NULL (just means no explicit base)
     base = b; 
     if (base) base->SetParent(this); 
@@ -473,22 +595,25 @@ FieldAccess::FieldAccess(Expr *b, Identifier *f)
 }
 
 
-void FieldAccess::PrintChildren(int indentLevel) {
-    if (base) base->Print(indentLevel+1);
-    field->Print(indentLevel+1);
+void FieldAccess::GetChildren(vector<Child> *children) {
+    AddChild(children, base);
+    AddChild(children, field);
 }
 
 Call::Call(yyltype loc, Expr *b, Identifier *f, List<Expr*> *a) : Expr(loc)  {
+    nodeKind = CallNode;
     Assert(f != NULL && a != NULL); // b can be be NULL (just means no explicit base)
     base = b;
     if (base) base->SetParent(this);
     (field=f)->SetParent(this);
     (actuals=a)->SetParentAll(this);
+    decl = NULL;
+    resolved = false;
 }
 
-void Call::PrintChildren(int indentLevel) {
-   if (base) base->Print(indentLevel+1);
-   if (field) field->Print(indentLevel+1);
-   if (actuals) actuals->PrintAll(indentLevel+1, "(actuals) ");
+void Call::GetChildren(vector<Child> *children) {
+   AddChild(children, base);
+   AddChild(children, field);
+   AddChildren(children, actuals, "(actuals) ");
 }
 
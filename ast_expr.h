@@ -20,11 +20,17 @@
 
 void yyerror(const char *msg);
 
+class VarDecl;
+class FnDecl;
+
 class Expr : public Stmt 
 {
+  protected:
+    bool checked;       // type is only meaningful once this is set
+
   public:
-    Expr(yyltype loc) : Stmt(loc) {}
-    Expr() : Stmt() {}
+    Expr(yyltype loc) : Stmt(loc), checked(false), type(NULL) {}
+    Expr() : Stmt(), checked(false), type(NULL) {}
     Type* type;
 
     friend std::ostream& operator<< (std::ostream& stream, Expr * expr) {
@@ -32,8 +38,33 @@ class Expr : public Stmt
     }
 
   //Check Functions
-  void Check() { CheckWithType(); }
-  virtual Type* CheckWithType(){ return NULL; }
+  //An expression is typed once its operands have been walked, unless it
+  //is itself an operand: typing the whole expression types those of its
+  //operands it needs.
+  void FinishCheck() {
+    if(parent == NULL || !IsExprKind(parent->GetNodeKind())){
+      CheckWithType();
+    }
+  }
+  //Types the expression the first time it is asked for, reporting any
+  //errors then. Later calls return the same type without checking again.
+  Type* CheckWithType(){
+    if(!checked){
+      CheckOperandsFirst();
+    }
+    return type;
+  }
+  bool IsChecked() const { return checked; }
+  //Does the checking for CheckWithType in each kind of expression
+  virtual Type* ComputeType(){ return NULL; }
+  //The next operand ComputeType would type that has not been typed yet,
+  //or NULL if there are no more. The operands are typed before
+  //ComputeType is called, in this order, so that it only ever finds
+  //types that are already known.
+  virtual Expr* UncheckedOperand(){ return NULL; }
+
+ private:
+  void CheckOperandsFirst();
 };
 
 class ExprError : public Expr
@@ -49,6 +80,7 @@ class ExprError : public Expr
 class EmptyExpr : public Expr
 {
   public:
+    EmptyExpr() : Expr() { nodeKind = EmptyExprNode; }
     const char *GetPrintNameForNode() { return "Empty"; }
 };
 
@@ -63,7 +95,7 @@ class IntConstant : public Expr
     void PrintChildren(int indentLevel);
 
     //Check Function
-    Type* CheckWithType();
+    Type* ComputeType();
 };
 
 class FloatConstant: public Expr 
@@ -77,7 +109,7 @@ class FloatConstant: public Expr
     void PrintChildren(int indentLevel);
 
     //Check Function
-    Type* CheckWithType();
+    Type* ComputeType();
 };
 
 class BoolConstant : public Expr 
@@ -91,35 +123,54 @@ class BoolConstant : public Expr
     void PrintChildren(int indentLevel);
 
     //Check Function
-    Type* CheckWithType();
+    Type* ComputeType();
 };
 
 class VarExpr : public Expr
 {
   protected:
     Identifier *id;
+    VarDecl *decl;      // what id names, once resolved
+    bool resolved;
 
   public:
     VarExpr(yyltype loc, Identifier *id);
     const char *GetPrintNameForNode() { return "VarExpr"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
     Identifier *GetIdentifier() {return id;}
+    //Binds id to the variable it names in the current scope, which the
+    //ResolvePass does as it reaches the expression
+    void Resolve();
+    //The variable Resolve() bound, or NULL if there is none
+    VarDecl *GetDecl() { Assert(resolved); return decl; }
 
   //Check Function
-  Type* CheckWithType();
+  Type* ComputeType();
 };
 
+//The operators, as the scanner hands them to the parser. Each has one
+//spelling, which is what the tree dump and error messages show.
+typedef enum {
+      AddOp, SubOp, MulOp, DivOp,
+      IncOp, DecOp,
+      LessOp, GreaterOp, LessEqualOp, GreaterEqualOp,
+      EqOp, NeOp, AndOp, OrOp,
+      AssignOp, AddAssignOp, SubAssignOp, MulAssignOp, DivAssignOp,
+      NumOpcodes
+} opcodeT;
+
 class Operator : public Node 
 {
   protected:
-    char tokenString[4];
+    opcodeT opcode;
     
   public:
-    Operator(yyltype loc, const char *tok);
+    Operator(yyltype loc, opcodeT opcode);
     const char *GetPrintNameForNode() { return "Operator"; }
     void PrintChildren(int indentLevel);
-    friend ostream& operator<<(ostream& out, Operator *o) { return out << o->tokenString; }
-    bool IsOp(const char *op) const;
+    friend ostream& operator<<(ostream& out, Operator *o) { return out << Spelling(o->opcode); }
+    bool IsOp(opcodeT op) const { return opcode == op; }
+    static const char *Spelling(opcodeT op);
  };
  
 class CompoundExpr : public Expr
@@ -132,70 +183,72 @@ class CompoundExpr : public Expr
     CompoundExpr(Expr *lhs, Operator *op, Expr *rhs); // for binary
     CompoundExpr(Operator *op, Expr *rhs);             // for unary
     CompoundExpr(Expr *lhs, Operator *op);             // for unary
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
+    Expr* UncheckedOperand();
 };
 
 class ArithmeticExpr : public CompoundExpr 
 {
   public:
-    ArithmeticExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) {}
-    ArithmeticExpr(Operator *op, Expr *rhs) : CompoundExpr(op,rhs) {}
+    ArithmeticExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) { nodeKind = ArithmeticNode; }
+    ArithmeticExpr(Operator *op, Expr *rhs) : CompoundExpr(op,rhs) { nodeKind = ArithmeticNode; }
     const char *GetPrintNameForNode() { return "ArithmeticExpr"; }
    
     //Check Function
-    Type* CheckWithType();
+    Type* ComputeType();
+    Expr* UncheckedOperand();
 
 };
 
 class RelationalExpr : public CompoundExpr 
 {
   public:
-    RelationalExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) {}
+    RelationalExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) { nodeKind = RelationalNode; }
     const char *GetPrintNameForNode() { return "RelationalExpr"; }
 
   //Check function
-  Type* CheckWithType();
+  Type* ComputeType();
 };
 
 class EqualityExpr : public CompoundExpr 
 {
   public:
-    EqualityExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) {}
+    EqualityExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) { nodeKind = EqualityNode; }
     const char *GetPrintNameForNode() { return "EqualityExpr"; }
    
     //Check function
-    Type* CheckWithType();
+    Type* ComputeType();
 };
 
 class LogicalExpr : public CompoundExpr 
 {
   public:
-    LogicalExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) {}
-    LogicalExpr(Operator *op, Expr *rhs) : CompoundExpr(op,rhs) {}
+    LogicalExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) { nodeKind = LogicalNode; }
+    LogicalExpr(Operator *op, Expr *rhs) : CompoundExpr(op,rhs) { nodeKind = LogicalNode; }
     const char *GetPrintNameForNode() { return "LogicalExpr"; }
 
     //Check function
-    Type* CheckWithType();
+    Type* ComputeType();
 };
 
 class AssignExpr : public CompoundExpr 
 {
   public:
-    AssignExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) {}
+    AssignExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) { nodeKind = AssignNode; }
     const char *GetPrintNameForNode() { return "AssignExpr"; }
   
     //Check Function
-    Type* CheckWithType();
+    Type* ComputeType();
 };
 
 class PostfixExpr : public CompoundExpr
 {
   public:
-    PostfixExpr(Expr *lhs, Operator *op) : CompoundExpr(lhs,op) {}
+    PostfixExpr(Expr *lhs, Operator *op) : CompoundExpr(lhs,op) { nodeKind = PostfixNode; }
     const char *GetPrintNameForNode() { return "PostfixExpr"; }
 
    //Check Function
-   Type* CheckWithType();
+   Type* ComputeType();
 
 };
 
@@ -205,7 +258,7 @@ class ConditionalExpr : public Expr
     Expr *cond, *trueExpr, *falseExpr;
   public:
     ConditionalExpr(Expr *c, Expr *t, Expr *f);
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
     const char *GetPrintNameForNode() { return "ConditionalExpr"; }
 };
 
@@ -223,10 +276,11 @@ class ArrayAccess : public LValue
   public:
     ArrayAccess(yyltype loc, Expr *base, Expr *subscript);
     const char *GetPrintNameForNode() { return "ArrayAccess"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
 
    //Check Function
-   Type* CheckWithType();
+   Type* ComputeType();
+   Expr* UncheckedOperand();
 };
 
 /* Note that field access is used both for qualified names
@@ -243,10 +297,13 @@ class FieldAccess : public LValue
   public:
     FieldAccess(Expr *base, Identifier *field); //ok to pass NULL base
     const char *GetPrintNameForNode() { return "FieldAccess"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
+    //The variable whose field is accessed, if the base names one
+    VarDecl *GetBaseDecl();
     
     //Check Function
-    Type* CheckWithType();
+    Type* ComputeType();
+    Expr* UncheckedOperand();
 };
 
 /* Like field access, call is used both for qualified base.field()
@@ -259,15 +316,21 @@ class Call : public Expr
     Expr *base;	// will be NULL if no explicit base
     Identifier *field;
     List<Expr*> *actuals;
+    FnDecl *decl;       // the function called, once resolved
+    bool resolved;
     
   public:
-    Call() : Expr(), base(NULL), field(NULL), actuals(NULL) {}
+    Call() : Expr(), base(NULL), field(NULL), actuals(NULL), decl(NULL), resolved(false) { nodeKind = CallNode; }
     Call(yyltype loc, Expr *base, Identifier *field, List<Expr*> *args);
     const char *GetPrintNameForNode() { return "Call"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
+    //Binds field to the function it names, like VarExpr::Resolve()
+    void Resolve();
+    FnDecl *GetDecl() { Assert(resolved); return decl; }
    
     //Check Function
-    Type* CheckWithType();
+    Type* ComputeType();
+    Expr* UncheckedOperand();
 };
 
 class ActualsError : public Call
@@ -10,13 +10,13 @@
 #include "symtable.h"
 
 Program::Program(List<Decl*> *d) {
+    nodeKind = ProgramNode;
     Assert(d != NULL);
     (decls=d)->SetParentAll(this);
 }
 
-void Program::PrintChildren(int indentLevel) {
-    decls->PrintAll(indentLevel+1);
-    printf("\n");
+void Program::GetChildren(vector<Child> *children) {
+    AddChildren(children, decls);
 }
 
 void Program::Check() {
@@ -28,57 +28,51 @@ void Program::Check() {
      *      and polymorphism in the node classes.
      */
 
-    // sample test - not the actual working code
-    // replace it with your own implementation
+    //The declarations are checked after this, in the global scope.
     if ( decls->NumElements() > 0 ) {
-      scope s;
-      symtable->pushScope(&s);
-      for ( int i = 0; i < decls->NumElements(); ++i ) {
-        Decl *d = decls->Nth(i);
-        //Our Code
-        //Start checking.
-        d->Check();
-      }
+      symtable->pushScope();
     }
 }
 
 StmtBlock::StmtBlock(List<VarDecl*> *d, List<Stmt*> *s) {
+    nodeKind = StmtBlockNode;
     Assert(d != NULL && s != NULL);
     (decls=d)->SetParentAll(this);
     (stmts=s)->SetParentAll(this);
 }
 
-void StmtBlock::PrintChildren(int indentLevel) {
-    decls->PrintAll(indentLevel+1);
-    stmts->PrintAll(indentLevel+1);
+void StmtBlock::GetChildren(vector<Child> *children) {
+    AddChildren(children, decls);
+    AddChildren(children, stmts);
+}
+
+//A block nested directly in another block opens a scope of its own;
+//other blocks share the scope of the statement or function they belong to.
+static bool IsNestedBlock(Node *block){
+    Node *n = block->GetParent();
+    return n != NULL && n->GetNodeKind() == StmtBlockNode;
 }
 
 void StmtBlock::Check(){
-    Node *n = this->GetParent();
-    StmtBlock *sBlock = dynamic_cast<StmtBlock*>(n);
-    if(sBlock != NULL){
-        scope s;
-        Node::symtable->pushScope(&s);
+    if(IsNestedBlock(this)){
+        Node::symtable->pushScope();
     }
-    List<Stmt*> *stmtList = this->stmts;
-    Stmt *stmt = NULL;
-    for(int i = 0; i < stmtList->NumElements(); i++){
-        stmt = stmtList->Nth(i);
-        stmt->Check();
+}
+
+void StmtBlock::FinishCheck(){
+    if(IsNestedBlock(this)){
+        Node::symtable->popScope();
     }
 }
 
 DeclStmt::DeclStmt(Decl *d) {
+    nodeKind = DeclStmtNode;
     Assert(d != NULL);
     (decl=d)->SetParent(this);
 }
 
-void DeclStmt::PrintChildren(int indentLevel) {
-    decl->Print(indentLevel+1);
-}
-
-void DeclStmt::Check(){
-    decl->CheckID(decl->GetIdentifier());
+void DeclStmt::GetChildren(vector<Child> *children) {
+    AddChild(children, decl);
 }
 
 ConditionalStmt::ConditionalStmt(Expr *t, Stmt *b) { 
@@ -88,7 +82,26 @@ ConditionalStmt::ConditionalStmt(Expr *t, Stmt *b) {
     
 }
 
-ForStmt::ForStmt(Expr *i, Expr *t, Expr *s, Stmt *b): LoopStmt(t, b) { 
+void ConditionalStmt::ChildChecked(Node *child){
+    if(child == test && test->CheckWithType() != Type::boolType){
+        ReportError::TestNotBoolean(test);
+    }
+}
+
+//The loop has a scope of its own, and break and continue are allowed
+//anywhere inside it.
+void LoopStmt::Check(){
+    Node::symtable->pushScope();
+    Node::symtable->enterBreakable(this);
+}
+
+void LoopStmt::FinishCheck(){
+    Node::symtable->exitBreakable();
+    Node::symtable->popScope();
+}
+
+ForStmt::ForStmt(Expr *i, Expr *t, Expr *s, Stmt *b): LoopStmt(t, b) {
+    nodeKind = ForNode;
     Assert(i != NULL && t != NULL && b != NULL);
     (init=i)->SetParent(this);
     step = s;
@@ -97,117 +110,62 @@ ForStmt::ForStmt(Expr *i, Expr *t, Expr *s, Stmt *b): LoopStmt(t, b) {
     
 }
 
-void ForStmt::PrintChildren(int indentLevel) {
-    init->Print(indentLevel+1, "(init) ");
-    test->Print(indentLevel+1, "(test) ");
-    if ( step )
-      step->Print(indentLevel+1, "(step) ");
-    body->Print(indentLevel+1, "(body) ");
-}
-
-void ForStmt::Check(){
-    scope s;
-    Node::symtable->pushScope(&s);
-    Node::symtable->forFlag = true;
-    Expr *e = this ->init;
-    e->CheckWithType();
-    Expr *t = this -> test;
-    Type *type = t -> CheckWithType();
-    if( type != Type::boolType){
-        ReportError::TestNotBoolean(t);
-    }
-    Expr *step = this -> step;
-    step -> CheckWithType();
-    Stmt *stmt = this -> body;
-    stmt->Check();
-    if(Node::symtable->breakFlag != true){
-        Node::symtable->popScope();
-    }
-    else{
-        Node::symtable->breakFlag = false;
-    }
-    Node::symtable->forFlag = false;
-}
-
-void WhileStmt::PrintChildren(int indentLevel) {
-    test->Print(indentLevel+1, "(test) ");
-    body->Print(indentLevel+1, "(body) ");
+void ForStmt::GetChildren(vector<Child> *children) {
+    AddChild(children, init, "(init) ");
+    AddChild(children, test, "(test) ");
+    AddChild(children, step, "(step) ");
+    AddChild(children, body, "(body) ");
 }
 
-void WhileStmt::Check(){
-    scope s;
-    Node::symtable->pushScope(&s);
-    Node::symtable->whileFlag = true;
-    Expr *t = this -> test;
-    Type *type = t -> CheckWithType();
-    if( type != Type::boolType){
-        ReportError::TestNotBoolean(t);
-    }
-    Stmt *stmt = this -> body;
-    stmt->Check();
-    if(Node::symtable->breakFlag != true){
-        Node::symtable->popScope();
-    }
-    else{
-        Node::symtable->breakFlag = false;
-        if(Node::symtable->ifFlag == true){
-            Node::symtable->popScope();
-        }
-    }
-    Node::symtable->whileFlag = false;
+void WhileStmt::GetChildren(vector<Child> *children) {
+    AddChild(children, test, "(test) ");
+    AddChild(children, body, "(body) ");
 }
 
-IfStmt::IfStmt(Expr *t, Stmt *tb, Stmt *eb): ConditionalStmt(t, tb) { 
+IfStmt::IfStmt(Expr *t, Stmt *tb, Stmt *eb): ConditionalStmt(t, tb) {
+    nodeKind = IfNode;
     Assert(t != NULL && tb != NULL); // else can be NULL
     elseBody = eb;
     if (elseBody) elseBody->SetParent(this);
 }
 
-void IfStmt::PrintChildren(int indentLevel) {
-    if (test) test->Print(indentLevel+1, "(test) ");
-    if (body) body->Print(indentLevel+1, "(then) ");
-    if (elseBody) elseBody->Print(indentLevel+1, "(else) ");
+void IfStmt::GetChildren(vector<Child> *children) {
+    AddChild(children, test, "(test) ");
+    AddChild(children, body, "(then) ");
+    AddChild(children, elseBody, "(else) ");
 }
 
 void IfStmt::Check(){
-    scope s;
-    Node::symtable->pushScope(&s);
-    Node::symtable->ifFlag = true;
-    Expr *t = this -> test;
-    Type *type = t -> CheckWithType();
-    if( type != Type::boolType){
-        ReportError::TestNotBoolean(t);
-    }
-    Stmt *stmtThen = this -> body;
-    stmtThen->Check();
-    Stmt *stmtElse = this -> elseBody;
-    if (stmtElse != NULL){
-        scope ss;
-        Node::symtable->pushScope(&ss);
-        stmtElse -> Check();
-        Node::symtable->popScope();
+    Node::symtable->pushScope();
+}
+
+//The else part gets a scope nested in the one the then part used.
+void IfStmt::ChildChecked(Node *child){
+    ConditionalStmt::ChildChecked(child);
+    if(child == body && elseBody != NULL){
+        Node::symtable->pushScope();
     }
-    Node::symtable->ifFlag = false;
-    if(Node::symtable->breakFlag != true){
+}
+
+void IfStmt::FinishCheck(){
+    if(elseBody != NULL){
         Node::symtable->popScope();
     }
-    else{
-        Node::symtable->breakFlag = false;
-    }
+    Node::symtable->popScope();
 }
 
 
-ReturnStmt::ReturnStmt(yyltype loc, Expr *e) : Stmt(loc) { 
+ReturnStmt::ReturnStmt(yyltype loc, Expr *e) : Stmt(loc) {
+    nodeKind = ReturnNode;
     expr = e;
     if (e != NULL) expr->SetParent(this);
 }
 
-void ReturnStmt::PrintChildren(int indentLevel) {
-    if ( expr ) 
-      expr->Print(indentLevel+1);
+void ReturnStmt::GetChildren(vector<Child> *children) {
+    AddChild(children, expr);
 }
 
-void ReturnStmt::Check(){
+void ReturnStmt::FinishCheck(){
     Node::symtable->returnFlag = true;
     Expr *e = this->expr;
     if( e != NULL){
@@ -236,12 +194,13 @@ SwitchLabel::SwitchLabel(Stmt *s) {
     (stmt=s)->SetParent(this);
 }
 
-void SwitchLabel::PrintChildren(int indentLevel) {
-    if (label) label->Print(indentLevel+1);
-    if (stmt)  stmt->Print(indentLevel+1);
+void SwitchLabel::GetChildren(vector<Child> *children) {
+    AddChild(children, label);
+    AddChild(children, stmt);
 }
 
 SwitchStmt::SwitchStmt(Expr *e, List<Stmt *> *c, Default *d) {
+    nodeKind = SwitchNode;
     Assert(e != NULL && c != NULL && c->NumElements() != 0 );
     (expr=e)->SetParent(this);
     (cases=c)->SetParentAll(this);
@@ -249,150 +208,30 @@ SwitchStmt::SwitchStmt(Expr *e, List<Stmt *> *c, Default *d) {
     if (def) def->SetParent(this);
 }
 
-void SwitchStmt::PrintChildren(int indentLevel) {
-    if (expr) expr->Print(indentLevel+1);
-    if (cases) cases->PrintAll(indentLevel+1);
-    if (def) def->Print(indentLevel+1);
-}
-
-void Case::Check(){
-    Expr *e = this->label;
-    e->CheckWithType();
-    Stmt *s = this->stmt;
-    s->Check();
-}
-
-void Default::Check(){
-    Stmt *s = this->stmt;
-    s->Check();
-}
-
-void SwitchLabel::Check(){
-    if(this->label != NULL){
-        this->label->CheckWithType();
-    }
-    
+void SwitchStmt::GetChildren(vector<Child> *children) {
+    AddChild(children, expr);
+    AddChildren(children, cases);
+    AddChild(children, def);
 }
 
 void SwitchStmt::Check(){
-    scope s;
-    Node::symtable->pushScope(&s);
-    Node::symtable->switchFlag = true;
-    
-    Expr *e = this->expr;
-    Type *t = e->CheckWithType();
+    Node::symtable->pushScope();
+    Node::symtable->enterBreakable(this);
+}
 
-    List<Stmt*> *c = this->cases;
-    Stmt *st = NULL;
-    for(int i = 0; i < c->NumElements(); i++){
-        st = c->Nth(i);
-        st->Check();
-    }
-    Default *d = this -> def;
-    if( d != NULL){
-        d->Check();
-    }
-    if(Node::symtable->breakFlag != true){
-        Node::symtable->popScope();
-    }
-    else{
-        Node::symtable->breakFlag = false;
-    }
-    Node::symtable->switchFlag = false;
+void SwitchStmt::FinishCheck(){
+    Node::symtable->exitBreakable();
+    Node::symtable->popScope();
 }
 
 void BreakStmt::Check(){
-    Node *n = this->GetParent();
-    ForStmt *fStmt = dynamic_cast<ForStmt*>(n);
-    WhileStmt *wStmt = dynamic_cast<WhileStmt*>(n);
-    SwitchStmt *sStmt = dynamic_cast<SwitchStmt*>(n);
-    StmtBlock *sBlock = dynamic_cast<StmtBlock*>(n);
-    
-    if(sBlock == NULL){
-        if(fStmt != NULL || wStmt != NULL){
-            Node::symtable->breakFlag = true;
-            Node::symtable->popScope();
-            return;
-        }
+    if(!Node::symtable->canBreak()){
         ReportError::BreakOutsideLoop(this);
     }
-
-    int counter = 0;
-    while(n!=NULL){
-        fStmt = dynamic_cast<ForStmt*>(n);
-        wStmt = dynamic_cast<WhileStmt*>(n);
-        sStmt = dynamic_cast<SwitchStmt*>(n);
-        sBlock = dynamic_cast<StmtBlock*>(n);
-
-        if(sBlock!=NULL){
-            Node *gma = n->GetParent();
-            if(gma != NULL){
-                fStmt = dynamic_cast<ForStmt*>(gma);
-                wStmt = dynamic_cast<WhileStmt*>(gma);
-                sStmt = dynamic_cast<SwitchStmt*>(gma);
-                if(fStmt != NULL || wStmt != NULL || sStmt != NULL){
-                    Node::symtable->breakFlag = true;
-                    for( int i = 0; i < counter;i++){
-                        Node::symtable->popScope();
-                    }
-                    symtable->breakFlag = true;
-                    return;
-                }
-                else{
-                    n = gma->GetParent();
-                    counter ++;
-                }
-            }
-        }
-        else{
-            ReportError::BreakOutsideLoop(this);
-            return;
-        }
-    }
 }
 
 void ContinueStmt::Check(){
-    Node *n = this->GetParent();
-    ForStmt *fStmt = dynamic_cast<ForStmt*>(n);
-    WhileStmt *wStmt = dynamic_cast<WhileStmt*>(n);
-    StmtBlock *sBlock = dynamic_cast<StmtBlock*>(n);
-    SwitchStmt *sStmt = dynamic_cast<SwitchStmt*>(n);
-    
-    if(sBlock == NULL){
-        if(fStmt != NULL || wStmt != NULL){
-            return;
-        }
+    if(!Node::symtable->canContinue()){
         ReportError::ContinueOutsideLoop(this);
     }
-
-    while(n!=NULL){
-        fStmt = dynamic_cast<ForStmt*>(n);
-        wStmt = dynamic_cast<WhileStmt*>(n);
-        sBlock = dynamic_cast<StmtBlock*>(n);
-        sStmt = dynamic_cast<SwitchStmt*>(n);
-
-        if(sBlock!=NULL){
-            Node *gma = n->GetParent();
-            if(gma != NULL){
-                fStmt = dynamic_cast<ForStmt*>(gma);
-                wStmt = dynamic_cast<WhileStmt*>(gma);
-                sStmt = dynamic_cast<SwitchStmt*>(gma);
-                if(fStmt != NULL || wStmt != NULL){
-                    if(wStmt != NULL) {}
-                    return;
-                }
-                else if(sStmt != NULL){
-                    ReportError::ContinueOutsideLoop(this);
-                    return;
-                }
-                else{
-                    n = gma->GetParent();
-                }
-            }
-        }
-        else{
-            ReportError::ContinueOutsideLoop(this);
-            return;
-        }
-    }
 }
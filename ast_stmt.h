@@ -31,7 +31,7 @@ class Program : public Node
   public:
      Program(List<Decl*> *declList);
      const char *GetPrintNameForNode() { return "Program"; }
-     void PrintChildren(int indentLevel);
+     void GetChildren(vector<Child> *children);
 
      //Check Function
      virtual void Check();
@@ -42,7 +42,6 @@ class Stmt : public Node
   public:
      Stmt() : Node() {}
      Stmt(yyltype loc) : Node(loc) {}
-     virtual void Check(){}
 };
 
 class StmtBlock : public Stmt 
@@ -54,8 +53,9 @@ class StmtBlock : public Stmt
   public:
     StmtBlock(List<VarDecl*> *variableDeclarations, List<Stmt*> *statements);
     const char *GetPrintNameForNode() { return "StmtBlock"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
     void Check();
+    void FinishCheck();
 };
 
 class DeclStmt: public Stmt 
@@ -66,8 +66,7 @@ class DeclStmt: public Stmt
   public:
     DeclStmt(Decl *d);
     const char *GetPrintNameForNode() { return "DeclStmt"; }
-    void PrintChildren(int indentLevel);
-    void Check();
+    void GetChildren(vector<Child> *children);
 
 };
   
@@ -81,6 +80,9 @@ class ConditionalStmt : public Stmt
     ConditionalStmt() : Stmt(), test(NULL), body(NULL) {}
     ConditionalStmt(Expr *testExpr, Stmt *body);
 
+    //Reports a test that is not a bool once it has been checked
+    void ChildChecked(Node *child);
+
 };
 
 class LoopStmt : public ConditionalStmt 
@@ -88,6 +90,8 @@ class LoopStmt : public ConditionalStmt
   public:
     LoopStmt(Expr *testExpr, Stmt *body)
             : ConditionalStmt(testExpr, body) {}
+    void Check();
+    void FinishCheck();
 };
 
 class ForStmt : public LoopStmt 
@@ -98,18 +102,16 @@ class ForStmt : public LoopStmt
   public:
     ForStmt(Expr *init, Expr *test, Expr *step, Stmt *body);
     const char *GetPrintNameForNode() { return "ForStmt"; }
-    void PrintChildren(int indentLevel);
-    void Check();
+    void GetChildren(vector<Child> *children);
 
 };
 
 class WhileStmt : public LoopStmt 
 {
   public:
-    WhileStmt(Expr *test, Stmt *body) : LoopStmt(test, body) {}
+    WhileStmt(Expr *test, Stmt *body) : LoopStmt(test, body) { nodeKind = WhileNode; }
     const char *GetPrintNameForNode() { return "WhileStmt"; }
-    void PrintChildren(int indentLevel);
-    void Check();
+    void GetChildren(vector<Child> *children);
 };
 
 class IfStmt : public ConditionalStmt 
@@ -118,11 +120,13 @@ class IfStmt : public ConditionalStmt
     Stmt *elseBody;
   
   public:
-    IfStmt() : ConditionalStmt(), elseBody(NULL) {}
+    IfStmt() : ConditionalStmt(), elseBody(NULL) { nodeKind = IfNode; }
     IfStmt(Expr *test, Stmt *thenBody, Stmt *elseBody);
     const char *GetPrintNameForNode() { return "IfStmt"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
     void Check();
+    void ChildChecked(Node *child);
+    void FinishCheck();
 };
 
 class IfStmtExprError : public IfStmt
@@ -135,7 +139,7 @@ class IfStmtExprError : public IfStmt
 class BreakStmt : public Stmt 
 {
   public:
-    BreakStmt(yyltype loc) : Stmt(loc) {}
+    BreakStmt(yyltype loc) : Stmt(loc) { nodeKind = BreakNode; }
     const char *GetPrintNameForNode() { return "BreakStmt"; }
     void Check();
 };
@@ -143,7 +147,7 @@ class BreakStmt : public Stmt
 class ContinueStmt : public Stmt 
 {
   public:
-    ContinueStmt(yyltype loc) : Stmt(loc) {}
+    ContinueStmt(yyltype loc) : Stmt(loc) { nodeKind = ContinueNode; }
     const char *GetPrintNameForNode() { return "ContinueStmt"; }
     void Check();
 };
@@ -156,8 +160,8 @@ class ReturnStmt : public Stmt
   public:
     ReturnStmt(yyltype loc, Expr *expr = NULL);
     const char *GetPrintNameForNode() { return "ReturnStmt"; }
-    void PrintChildren(int indentLevel);
-    void Check();
+    void GetChildren(vector<Child> *children);
+    void FinishCheck();
 };
 
 class SwitchLabel : public Stmt
@@ -170,26 +174,23 @@ class SwitchLabel : public Stmt
     SwitchLabel() { label = NULL; stmt = NULL; }
     SwitchLabel(Expr *label, Stmt *stmt);
     SwitchLabel(Stmt *stmt);
-    void PrintChildren(int indentLevel);
-    void Check();
+    void GetChildren(vector<Child> *children);
 
 };
 
 class Case : public SwitchLabel
 {
   public:
-    Case() : SwitchLabel() {}
-    Case(Expr *label, Stmt *stmt) : SwitchLabel(label, stmt) {}
+    Case() : SwitchLabel() { nodeKind = CaseNode; }
+    Case(Expr *label, Stmt *stmt) : SwitchLabel(label, stmt) { nodeKind = CaseNode; }
     const char *GetPrintNameForNode() { return "Case"; }
-    void Check();
 };
 
 class Default : public SwitchLabel
 {
   public:
-    Default(Stmt *stmt) : SwitchLabel(stmt) {}
+    Default(Stmt *stmt) : SwitchLabel(stmt) { nodeKind = DefaultNode; }
     const char *GetPrintNameForNode() { return "Default"; }
-    void Check();
 };
 
 class SwitchStmt : public Stmt
@@ -200,11 +201,12 @@ class SwitchStmt : public Stmt
     Default *def;
 
   public:
-    SwitchStmt() : expr(NULL), cases(NULL), def(NULL) {}
+    SwitchStmt() : expr(NULL), cases(NULL), def(NULL) { nodeKind = SwitchNode; }
     SwitchStmt(Expr *expr, List<Stmt*> *cases, Default *def);
     virtual const char *GetPrintNameForNode() { return "SwitchStmt"; }
-    void PrintChildren(int indentLevel);
+    void GetChildren(vector<Child> *children);
     void Check();
+    void FinishCheck();
 
 };
 
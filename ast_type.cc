@@ -12,39 +12,51 @@
  * These are public constants for the built-in base types (int, double, etc.)
  * They can be accessed with the syntax Type::intType. This allows you to
  * directly access them and share the built-in types where needed rather that
- * creates lots of copies.
+ * creates lots of copies. One set serves every thread: nothing changes
+ * them once they are made, since a type shared by many declarations is
+ * not given a parent. They are made on the heap, outside the arena of
+ * any translation unit.
  */
 
-Type *Type::intType    = new Type("int");
-Type *Type::floatType  = new Type("float");
-Type *Type::voidType   = new Type("void");
-Type *Type::boolType   = new Type("bool");
-Type *Type::mat2Type   = new Type("mat2");
-Type *Type::mat3Type   = new Type("mat3");
-Type *Type::mat4Type   = new Type("mat4");
-Type *Type::vec2Type   = new Type("vec2");
-Type *Type::vec3Type   = new Type("vec3");
-Type *Type::vec4Type   = new Type("vec4");
-Type *Type::ivec2Type = new Type("ivec2");
-Type *Type::ivec3Type = new Type("ivec3");
-Type *Type::ivec4Type = new Type("ivec4");
-Type *Type::bvec2Type = new Type("bvec2");
-Type *Type::bvec3Type = new Type("bvec3");
-Type *Type::bvec4Type = new Type("bvec4");
-Type *Type::uintType = new Type("uint");
-Type *Type::uvec2Type = new Type("uvec2");
-Type *Type::uvec3Type = new Type("uvec3");
-Type *Type::uvec4Type = new Type("uvec4");
-Type *Type::errorType  = new Type("error"); 
+template <class T, class... Args> static T *Builtin(Args... args) {
+    HeapAllocation heap;
+    return new T(args...);
+}
+
+Type *Type::intType    = Builtin<Type>("int", IntKind);
+Type *Type::floatType  = Builtin<Type>("float", FloatKind);
+Type *Type::voidType   = Builtin<Type>("void", VoidKind);
+Type *Type::boolType   = Builtin<Type>("bool", BoolKind);
+Type *Type::mat2Type   = Builtin<Type>("mat2", Mat2Kind);
+Type *Type::mat3Type   = Builtin<Type>("mat3", Mat3Kind);
+Type *Type::mat4Type   = Builtin<Type>("mat4", Mat4Kind);
+Type *Type::vec2Type   = Builtin<Type>("vec2", Vec2Kind);
+Type *Type::vec3Type   = Builtin<Type>("vec3", Vec3Kind);
+Type *Type::vec4Type   = Builtin<Type>("vec4", Vec4Kind);
+Type *Type::ivec2Type = Builtin<Type>("ivec2", IVec2Kind);
+Type *Type::ivec3Type = Builtin<Type>("ivec3", IVec3Kind);
+Type *Type::ivec4Type = Builtin<Type>("ivec4", IVec4Kind);
+Type *Type::bvec2Type = Builtin<Type>("bvec2", BVec2Kind);
+Type *Type::bvec3Type = Builtin<Type>("bvec3", BVec3Kind);
+Type *Type::bvec4Type = Builtin<Type>("bvec4", BVec4Kind);
+Type *Type::uintType = Builtin<Type>("uint", UintKind);
+Type *Type::uvec2Type = Builtin<Type>("uvec2", UVec2Kind);
+Type *Type::uvec3Type = Builtin<Type>("uvec3", UVec3Kind);
+Type *Type::uvec4Type = Builtin<Type>("uvec4", UVec4Kind);
+Type *Type::errorType  = Builtin<Type>("error", ErrorKind); 
+
+TypeQualifier *TypeQualifier::inTypeQualifier  = Builtin<TypeQualifier>("in");
+TypeQualifier *TypeQualifier::outTypeQualifier = Builtin<TypeQualifier>("out");
+TypeQualifier *TypeQualifier::constTypeQualifier = Builtin<TypeQualifier>("const");
+TypeQualifier *TypeQualifier::uniformTypeQualifier = Builtin<TypeQualifier>("uniform");
 
-TypeQualifier *TypeQualifier::inTypeQualifier  = new TypeQualifier("in");
-TypeQualifier *TypeQualifier::outTypeQualifier = new TypeQualifier("out");
-TypeQualifier *TypeQualifier::constTypeQualifier = new TypeQualifier("const");
-TypeQualifier *TypeQualifier::uniformTypeQualifier = new TypeQualifier("uniform");
+constexpr TypeShape Type::shapes[];
 
-Type::Type(const char *n) {
+Type::Type(const char *n, typeKindT k) {
+    nodeKind = TypeNode;
     Assert(n);
     typeName = strdup(n);
+    kind = k;
 }
 
 void Type::PrintChildren(int indentLevel) {
@@ -52,6 +64,7 @@ void Type::PrintChildren(int indentLevel) {
 }
 
 TypeQualifier::TypeQualifier(const char *n) {
+    nodeKind = TypeQualifierNode;
     Assert(n);
     typeQualifierName = strdup(n);
 }
@@ -60,42 +73,30 @@ void TypeQualifier::PrintChildren(int indentLevel) {
     printf("%s", typeQualifierName);
 }
 
-bool Type::IsNumeric() { 
-    return this->IsEquivalentTo(Type::intType) || this->IsEquivalentTo(Type::floatType);
-}
-
-bool Type::IsVector() { 
-    return this->IsEquivalentTo(Type::vec2Type) || 
-           this->IsEquivalentTo(Type::vec3Type) ||  
-           this->IsEquivalentTo(Type::vec4Type);
-}
-
-bool Type::IsMatrix() { 
-    return this->IsEquivalentTo(Type::mat2Type) || 
-           this->IsEquivalentTo(Type::mat3Type) ||  
-           this->IsEquivalentTo(Type::mat4Type);
-}
-
-bool Type::IsError() { 
-    return this->IsEquivalentTo(Type::errorType);
-}
-	
-NamedType::NamedType(Identifier *i) : Type(*i->GetLocation()) {
+NamedType::NamedType(Identifier *i) : Type(*i->GetLocation(), NamedKind) {
     Assert(i != NULL);
     (id=i)->SetParent(this);
 } 
 
-void NamedType::PrintChildren(int indentLevel) {
-    id->Print(indentLevel+1);
+void NamedType::GetChildren(vector<Child> *children) {
+    AddChild(children, id);
 }
 
-ArrayType::ArrayType(yyltype loc, Type *et, int ec) : Type(loc) {
+ArrayType::ArrayType(Type *et, int ec) : Type(ArrayKind) {
     Assert(et != NULL);
-    (elemType=et)->SetParent(this);
+    elemType = et;
     elemCount=ec;
 }
-void ArrayType::PrintChildren(int indentLevel) {
-    elemType->Print(indentLevel+1);
+void ArrayType::GetChildren(vector<Child> *children) {
+    AddChild(children, elemType);
+}
+
+ArrayType *TypeTable::ArrayOf(Type *elemType, int elemCount) {
+    ArrayKey key = { elemType, elemCount };
+    ArrayType *&type = arrays[key];
+    if (type == NULL)
+        type = new ArrayType(elemType, elemCount);
+    return type;
 }
 
 
@@ -15,9 +15,36 @@
 #include "ast.h"
 #include "list.h"
 #include <iostream>
+#include <unordered_map>
 
 using namespace std;
 
+/* Every type has a kind. Each built-in type has a kind of its own, so the
+ * kind alone says everything about it; named and array types share a kind
+ * per class.
+ */
+typedef enum {
+      ErrorKind, VoidKind,
+      BoolKind, IntKind, UintKind, FloatKind,
+      Vec2Kind, Vec3Kind, Vec4Kind,
+      IVec2Kind, IVec3Kind, IVec4Kind,
+      BVec2Kind, BVec3Kind, BVec4Kind,
+      UVec2Kind, UVec3Kind, UVec4Kind,
+      Mat2Kind, Mat3Kind, Mat4Kind,
+      NamedKind, ArrayKind,
+      NumTypeKinds
+} typeKindT;
+
+/* The shape of the values of each kind: the scalar kind of a component,
+ * and the components arranged as columns of rows. Scalars are 1x1,
+ * vectors are a single column. The flags answer the type predicates.
+ */
+struct TypeShape {
+    typeKindT scalar;
+    int columns, rows;
+    unsigned flags;
+};
+
 class TypeQualifier : public Node
 {
   protected:
@@ -26,7 +53,7 @@ class TypeQualifier : public Node
   public :
     static TypeQualifier *inTypeQualifier, *outTypeQualifier, *constTypeQualifier, *uniformTypeQualifier;
 
-    TypeQualifier(yyltype loc) : Node(loc) {}
+    TypeQualifier(yyltype loc) : Node(loc) { nodeKind = TypeQualifierNode; }
     TypeQualifier(const char *str);
 
     const char *GetPrintNameForNode() { return "TypeQualifier"; }
@@ -35,10 +62,42 @@ class TypeQualifier : public Node
 
 class Type : public Node 
 {
+  public :
+    enum { NumericFlag = 1, VectorFlag = 2, MatrixFlag = 4, ErrorFlag = 8 };
+
   protected:
     char *typeName;
+    typeKindT kind;
+
+    static constexpr TypeShape shapes[NumTypeKinds] = {
+      /* ErrorKind */  { ErrorKind, 0, 0, ErrorFlag },
+      /* VoidKind */   { VoidKind,  0, 0, 0 },
+      /* BoolKind */   { BoolKind,  1, 1, 0 },
+      /* IntKind */    { IntKind,   1, 1, NumericFlag },
+      /* UintKind */   { UintKind,  1, 1, 0 },
+      /* FloatKind */  { FloatKind, 1, 1, NumericFlag },
+      /* Vec2Kind */   { FloatKind, 1, 2, VectorFlag },
+      /* Vec3Kind */   { FloatKind, 1, 3, VectorFlag },
+      /* Vec4Kind */   { FloatKind, 1, 4, VectorFlag },
+      /* IVec2Kind */  { IntKind,   1, 2, 0 },
+      /* IVec3Kind */  { IntKind,   1, 3, 0 },
+      /* IVec4Kind */  { IntKind,   1, 4, 0 },
+      /* BVec2Kind */  { BoolKind,  1, 2, 0 },
+      /* BVec3Kind */  { BoolKind,  1, 3, 0 },
+      /* BVec4Kind */  { BoolKind,  1, 4, 0 },
+      /* UVec2Kind */  { UintKind,  1, 2, 0 },
+      /* UVec3Kind */  { UintKind,  1, 3, 0 },
+      /* UVec4Kind */  { UintKind,  1, 4, 0 },
+      /* Mat2Kind */   { FloatKind, 2, 2, MatrixFlag },
+      /* Mat3Kind */   { FloatKind, 3, 3, MatrixFlag },
+      /* Mat4Kind */   { FloatKind, 4, 4, MatrixFlag },
+      /* NamedKind */  { NamedKind, 0, 0, 0 },
+      /* ArrayKind */  { ArrayKind, 0, 0, 0 },
+    };
 
   public :
+    static constexpr const TypeShape &ShapeOf(typeKindT k) { return shapes[k]; }
+
     static Type *intType, *uintType,*floatType, *boolType, *voidType,
                 *vec2Type, *vec3Type, *vec4Type,
                 *mat2Type, *mat3Type, *mat4Type,
@@ -47,8 +106,9 @@ class Type : public Node
                 *uvec2Type, *uvec3Type,*uvec4Type, 
                 *errorType;
 
-    Type(yyltype loc) : Node(loc) {}
-    Type(const char *str);
+    Type(yyltype loc, typeKindT k) : Node(loc), kind(k) { nodeKind = TypeNode; }
+    Type(typeKindT k) : Node(), typeName(NULL), kind(k) { nodeKind = TypeNode; }
+    Type(const char *str, typeKindT k);
     
     const char *GetPrintNameForNode() { return "Type"; }
     void PrintChildren(int indentLevel);
@@ -57,10 +117,17 @@ class Type : public Node
     friend ostream& operator<<(ostream& out, Type *t) { t->PrintToStream(out); return out; }
     virtual bool IsEquivalentTo(Type *other) { return (this == other); }
     virtual bool IsConvertibleTo(Type *other) { return (this == other || other == errorType); }
-    bool IsNumeric();
-    bool IsVector();
-    bool IsMatrix();
-    bool IsError();
+
+    typeKindT GetKind() { return kind; }
+    typeKindT GetScalarKind() { return shapes[kind].scalar; }
+    int NumColumns() { return shapes[kind].columns; }
+    int NumRows() { return shapes[kind].rows; }
+    int NumComponents() { return shapes[kind].columns * shapes[kind].rows; }
+
+    bool IsNumeric() { return shapes[kind].flags & NumericFlag; }
+    bool IsVector() { return shapes[kind].flags & VectorFlag; }
+    bool IsMatrix() { return shapes[kind].flags & MatrixFlag; }
+    bool IsError() { return shapes[kind].flags & ErrorFlag; }
 };
 
 
@@ -73,7 +140,8 @@ class NamedType : public Type
     NamedType(Identifier *i);
     
     const char *GetPrintNameForNode() { return "NamedType"; }
-    void PrintChildren(int indentLevel);
+    void PrintChildren(int indentLevel) {}      // printed by its children
+    void GetChildren(vector<Child> *children);
     void PrintToStream(ostream& out) { out << id; }
 };
 
@@ -84,13 +152,43 @@ class ArrayType : public Type
     int   elemCount;
 
   public:
-    ArrayType(yyltype loc, Type *elemType, int elemCount);
+    ArrayType(Type *elemType, int elemCount);
     
     const char *GetPrintNameForNode() { return "ArrayType"; }
-    void PrintChildren(int indentLevel);
-    void PrintToStream(ostream& out) { out << elemType << "[]"; }
+    void PrintChildren(int indentLevel) {}      // printed by its children
+    void GetChildren(vector<Child> *children);
+    void PrintToStream(ostream& out) { out << elemType << "[" << elemCount << "]"; }
     Type *GetElemType() {return elemType;}
+    int GetElemCount() {return elemCount;}
+};
+
+/* Each Context keeps one TypeTable, which makes sure there is only one
+ * ArrayType for each element type and count. Element types are canonical
+ * themselves, so two array types are equivalent exactly when they are
+ * the same pointer, as the built-in types are. The types are allocated
+ * in the current arena the first time they are asked for. Like the
+ * built-in types they belong to no one declaration, so they have no
+ * location or parent; each declaration keeps where it names its type.
+ */
+class TypeTable
+{
+  protected:
+    struct ArrayKey {
+        Type *elemType;
+        int elemCount;
+        bool operator==(const ArrayKey &other) const
+            { return elemType == other.elemType && elemCount == other.elemCount; }
+    };
+    struct ArrayKeyHash {
+        size_t operator()(const ArrayKey &k) const
+            { return hash<Type*>()(k.elemType) * 31 + k.elemCount; }
+    };
+
+    unordered_map<ArrayKey, ArrayType*, ArrayKeyHash> arrays;
+
+  public:
+    // Returns the type of arrays of elemCount elements of elemType
+    ArrayType *ArrayOf(Type *elemType, int elemCount);
 };
 
- 
 #endif
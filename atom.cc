@@ -0,0 +1,85 @@
+/* File: atom.cc
+ * -------------
+ * Implementation of the atom table.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "atom.h"
+#include "utility.h"
+
+static const int InitialSlots = 256;    // must be a power of two
+static const int BlockSize = 4096;
+
+AtomTable::AtomTable() : count(0), nextChar(NULL), charsLeft(0) {
+    Slot empty = { 0, 0, NULL };
+    slots.assign(InitialSlots, empty);
+}
+
+AtomTable::~AtomTable() {
+    for (int i = 0; i < blocks.size(); i++)
+        free(blocks[i]);
+}
+
+/* FNV-1a; identifiers are short, so a simple byte-at-a-time hash is
+ * as quick as anything fancier.
+ */
+static unsigned HashName(const char *text, int length) {
+    unsigned h = 2166136261u;
+    for (int i = 0; i < length; i++)
+        h = (h ^ (unsigned char)text[i]) * 16777619u;
+    return h;
+}
+
+Atom AtomTable::Intern(const char *text, int length) {
+    unsigned hash = HashName(text, length);
+    unsigned mask = slots.size() - 1;
+    for (unsigned i = hash & mask; ; i = (i + 1) & mask) {
+        Slot &s = slots[i];
+        if (s.atom == NULL) {
+            Atom atom = Store(text, length);
+            s.hash = hash;
+            s.length = length;
+            s.atom = atom;
+            if (++count * 2 > slots.size())   // keep the load under 1/2
+                Grow();
+            return atom;
+        }
+        if (s.hash == hash && s.length == length && memcmp(s.atom, text, length) == 0)
+            return s.atom;
+    }
+}
+
+/* Names are copied into large blocks that are only freed with the
+ * table, so interning a new name rarely calls malloc.
+ */
+Atom AtomTable::Store(const char *text, int length) {
+    if (length + 1 > charsLeft) {
+        int size = (length + 1 > BlockSize)? length + 1 : BlockSize;
+        nextChar = (char *)malloc(size);
+        if (!nextChar) Failure("Out of memory!");
+        blocks.push_back(nextChar);
+        charsLeft = size;
+    }
+    char *atom = nextChar;
+    memcpy(atom, text, length);
+    atom[length] = '\0';
+    nextChar += length + 1;
+    charsLeft -= length + 1;
+    return atom;
+}
+
+void AtomTable::Grow() {
+    vector<Slot> old;
+    old.swap(slots);
+    Slot empty = { 0, 0, NULL };
+    slots.assign(old.size() * 2, empty);
+    unsigned mask = slots.size() - 1;
+    for (int j = 0; j < old.size(); j++) {
+        if (old[j].atom == NULL) continue;
+        unsigned i = old[j].hash & mask;
+        while (slots[i].atom != NULL)
+            i = (i + 1) & mask;
+        slots[i] = old[j];
+    }
+}
@@ -0,0 +1,50 @@
+/* File: atom.h
+ * ------------
+ * Identifier interning. The scanner turns the name of every identifier
+ * into an Atom, which is what Identifier nodes store and what the symbol
+ * table is keyed by. The AtomTable hands out exactly one Atom for each
+ * distinct name, so two names are the same exactly when their atoms are
+ * the same pointer: comparing and hashing names never looks at their
+ * characters again, and no per-lookup string copies are needed.
+ *
+ * An Atom points at the interned, NUL-terminated name, so it can be
+ * printed or passed anywhere a C string is expected. Each Context has
+ * its own table; atoms from different translation units must not be
+ * compared with each other.
+ */
+
+#ifndef _H_atom
+#define _H_atom
+
+#include <vector>
+
+using namespace std;
+
+typedef const char *Atom;
+
+class AtomTable {
+  protected:
+    struct Slot {
+        unsigned hash;
+        int length;
+        Atom atom;          // NULL if the slot is empty
+    };
+
+    vector<Slot> slots;     // open addressing, size is a power of two
+    int count;
+    vector<char*> blocks;   // storage for the names
+    char *nextChar;
+    int charsLeft;
+
+    Atom Store(const char *text, int length);
+    void Grow();
+
+  public:
+    AtomTable();
+    ~AtomTable();
+
+    // Returns the atom for the first length characters of text
+    Atom Intern(const char *text, int length);
+};
+
+#endif
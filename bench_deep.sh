@@ -0,0 +1,47 @@
+#! /bin/sh
+#
+# Regression benchmark for very deep expression trees. Generates shaders
+# whose single expression is N levels deep (100000 unless given) and
+# times glc on each:
+#   chain   a + a + ... + a        left-deep, one node per operator
+#   assign  a = a = ... = a        right-deep, nests on the parser stack
+#   paren   ((( ... (a) ... )))    nested parentheses
+# A shader fails if glc dies on a signal or reports anything, which is
+# how a stack overflow or an exhausted parser stack shows up.
+
+[ -x ./glc ] || { echo "Error: glc not executable"; exit 1; }
+
+DEPTH=${1:-100000}
+SHADER=bench_deep.glsl
+STATUS=0
+
+for kind in chain assign paren; do
+	awk -v n=$DEPTH -v kind=$kind 'BEGIN {
+		printf "void main() {\n  float a;\n  a = "
+		if (kind == "paren") {
+			for (i = 0; i < n; i++) printf "("
+			printf "a"
+			for (i = 0; i < n; i++) printf ")"
+		} else {
+			op = (kind == "chain")? " + " : " = "
+			for (i = 1; i < n; i++) printf "a%s", op
+			printf "a"
+		}
+		printf ";\n}\n"
+	}' > $SHADER
+	start=`date +%s.%N`
+	./glc < $SHADER > /dev/null 2> bench_deep.err
+	rc=$?
+	end=`date +%s.%N`
+	secs=`echo "$start $end" | awk '{ printf "%.3f", $2 - $1 }'`
+	if [ $rc -ge 128 ] || [ -s bench_deep.err ]; then
+		echo "$kind depth $DEPTH: FAILED (exit $rc) after ${secs}s"
+		head -c 200 bench_deep.err; echo
+		STATUS=1
+	else
+		echo "$kind depth $DEPTH: ${secs}s"
+	fi
+done
+
+rm -f $SHADER bench_deep.err
+exit $STATUS
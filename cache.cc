@@ -0,0 +1,136 @@
+/* File: cache.cc
+ * --------------
+ * Implementation of the on-disk result cache.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <atomic>
+#include "cache.h"
+#include "utility.h"
+
+static inline uint64_t Rotate(uint64_t x, int bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+static inline uint64_t MixWord(uint64_t h, uint64_t word) {
+    word *= 0x87c37b91114253d5ULL;
+    word = Rotate(word, 31);
+    word *= 0x4cf5ad432745937fULL;
+    h ^= word;
+    return Rotate(h, 27) * 5 + 0x52dce729;
+}
+
+/* Consumes the input eight bytes at a time with the MurmurHash3 mixing
+ * steps and finishes with its avalanche, which is plenty for telling
+ * shader sources apart and runs at several GB/s.
+ */
+uint64_t HashBytes(const void *data, size_t size, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t h = seed ^ (size * 0x9e3779b97f4a7c15ULL);
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        h = MixWord(h, word);
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, p, size);
+    h = MixWord(h, tail);
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/* The executable is hashed rather than a version string so that a
+ * rebuild with different checking rules can never replay stale results.
+ */
+uint64_t ExecutableHash() {
+    uint64_t hash;
+    string exe;
+    FILE *fp = fopen("/proc/self/exe", "rb");
+    if (fp && ReadWholeFile(fp, &exe))
+        hash = HashBytes(exe.data(), exe.size());
+    else
+        hash = HashBytes(__DATE__ __TIME__, strlen(__DATE__ __TIME__));
+    if (fp) fclose(fp);
+    return hash;
+}
+
+/* Entries are spread over 256 subdirectories named by the first two hex
+ * digits of the key, to keep directories small for large corpora.
+ */
+string CacheEntryPath(const string &dir, uint64_t key, const char *suffix, bool makeDir) {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    string subdir = dir + "/" + string(name, 2);
+    if (makeDir)
+        mkdir(subdir.c_str(), 0777);
+    return subdir + "/" + (name + 2) + suffix;
+}
+
+bool WriteFileAtomically(const string &path, const string &contents) {
+    static atomic<unsigned> counter(0);
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".tmp.%d.%u", (int)getpid(), counter++);
+    string temp = path + suffix;
+
+    FILE *fp = fopen(temp.c_str(), "wb");
+    if (!fp) return false;
+    fwrite(contents.data(), 1, contents.size(), fp);
+    bool ok = !ferror(fp);
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+ResultCache::ResultCache(const char *d) : dir(d) {
+    versionHash = ExecutableHash();
+    mkdir(dir.c_str(), 0777);
+}
+
+string ResultCache::EntryPath(const string &source, bool makeDir) {
+    return CacheEntryPath(dir, HashBytes(source.data(), source.size(), versionHash), "", makeDir);
+}
+
+bool ResultCache::Lookup(const string &source, int *numErrors, string *diagnostics) {
+    FILE *fp = fopen(EntryPath(source, false).c_str(), "rb");
+    if (!fp) return false;
+    string entry;
+    bool ok = ReadWholeFile(fp, &entry);
+    fclose(fp);
+    if (!ok) return false;
+
+    // The header is two lines: the format tag, then the three lengths
+    const string tag = "glc-cache 1\n";
+    size_t headerEnd = entry.find('\n', tag.size());
+    long sourceLength, textLength;
+    int errors;
+    if (entry.compare(0, tag.size(), tag) != 0 || headerEnd == string::npos
+        || sscanf(entry.c_str() + tag.size(), "%ld %d %ld",
+                  &sourceLength, &errors, &textLength) != 3)
+        return false;
+    size_t headerLength = headerEnd + 1;
+    if (sourceLength != source.size() || errors < 0
+        || headerLength + textLength != entry.size())
+        return false;
+    *numErrors = errors;
+    diagnostics->assign(entry, headerLength, textLength);
+    return true;
+}
+
+void ResultCache::Store(const string &source, int numErrors, const string &diagnostics) {
+    char header[64];
+    snprintf(header, sizeof(header), "glc-cache 1\n%ld %d %ld\n", (long)source.size(),
+             numErrors, (long)diagnostics.size());
+    WriteFileAtomically(EntryPath(source, true), header + diagnostics);
+}
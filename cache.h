@@ -0,0 +1,57 @@
+/* File: cache.h
+ * -------------
+ * An on-disk cache of check results, enabled with --cache-dir. Results
+ * are addressed by a hash of the shader source and of the glc executable
+ * itself, so rebuilding the compiler invalidates every entry. A hit gives
+ * back the error count and the diagnostic text, which the driver replays
+ * in place of scanning, parsing and checking the source again. The
+ * cache is off whenever -d, --stats-json or --trace is given, since
+ * none of what they report is stored.
+ *
+ * Entries are written to a temporary file and renamed into place, so any
+ * number of glc processes and threads can share a directory: a reader
+ * sees either a whole entry or none. Entries that fail to parse or whose
+ * recorded source length does not match are treated as misses.
+ */
+
+#ifndef _H_cache
+#define _H_cache
+
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+class ResultCache {
+  protected:
+    string dir;
+    uint64_t versionHash;   // hash of the glc executable
+
+    string EntryPath(const string &source, bool makeDir);
+
+  public:
+    ResultCache(const char *dir);
+
+    // Returns true and fills in the result if source has a stored entry
+    bool Lookup(const string &source, int *numErrors, string *diagnostics);
+
+    // Records the result of checking source; failures are ignored, since
+    // the cache is only an optimization
+    void Store(const string &source, int numErrors, const string &diagnostics);
+};
+
+// A fast 64-bit hash of size bytes of data, continuing from seed
+uint64_t HashBytes(const void *data, size_t size, uint64_t seed = 0);
+
+// A hash of the running glc executable, to seed the keys of cache entries
+uint64_t ExecutableHash();
+
+// The path of the entry in dir with the given key and suffix, creating
+// its subdirectory first if makeDir is set
+string CacheEntryPath(const string &dir, uint64_t key, const char *suffix, bool makeDir);
+
+// Writes contents to a temporary file and renames it to path, so that
+// readers see the whole file or none of it. Returns false on failure.
+bool WriteFileAtomically(const string &path, const string &contents);
+
+#endif
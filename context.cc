@@ -0,0 +1,114 @@
+/* File: context.cc
+ * ----------------
+ * Implementation of the per-translation-unit Context.
+ */
+
+#include <stdlib.h>
+#include "context.h"
+#include "scanner.h"
+#include "parser.h"
+#include "symtable.h"
+#include "ast_type.h"
+#include "utility.h"
+#include "trace.h"
+
+thread_local Context *Context::current = NULL;
+
+Context::Context(FILE *input, ostream *errorStream) : errors(errorStream) {
+    ReadWholeFile(input, &source);
+    Init();
+}
+
+Context::Context(const char *text, int length, ostream *errorStream)
+  : source(text, length), errors(errorStream) {
+    Init();
+}
+
+/* flex requires the buffer it scans in place to end with two NULs,
+ * which are not part of the input.
+ */
+void Context::Init() {
+    sourceLength = source.size();
+    source.append(2, '\0');
+    lineStarts.push_back(0);
+    heldPos = NULL;
+    heldChar = '\0';
+    tokenReader = NULL;
+    tokenRecorder = NULL;
+    curLineNum = 1;
+    curColNum = 1;
+    symtable = new SymbolTable();
+    types = new TypeTable();
+    InitScanner(this);
+}
+
+Context::~Context() {
+    DestroyScanner(this);
+    delete symtable;
+    delete types;
+}
+
+int Context::Parse() {
+    Context *prev = current;
+    SymbolTable *prevTable = Node::GetSymbolTable();
+    Arena *prevArena = Arena::SetCurrent(&arena);
+    Stats *prevStats = Stats::SetCurrent(Stats::IsEnabled()? &stats : NULL);
+    current = this;
+    Node::SetSymbolTable(symtable);
+    Trace::Begin("parse");
+    Stats::Clock::time_point start = Stats::Clock::now();
+    int result = yyparse(this, scanner);
+    RecordStats(Stats::Clock::now() - start);
+    if (Stats::Current() == &stats)
+        Trace::End("parse", "lex_ms", stats.times[Stats::ScanPhase]);
+    else
+        Trace::End("parse");
+    Node::SetSymbolTable(prevTable);
+    Stats::SetCurrent(prevStats);
+    Arena::SetCurrent(prevArena);
+    current = prev;
+    return result;
+}
+
+int Context::NextToken(YYSTYPE *value, yyltype *loc) {
+    Context *prev = current;
+    current = this;
+    int token = yylex(value, loc, scanner);
+    current = prev;
+    return token;
+}
+
+/* Scanning and checking both happen inside yyparse and are timed on
+ * their own, so the parse phase is what is left of the whole call. Both
+ * it and the scan time are then corrected for the cost of timing each
+ * call to yylex (see stats.h).
+ */
+void Context::RecordStats(Stats::Clock::duration total) {
+    if (Stats::Current() != &stats) return;
+    Stats::Clock::duration timing = stats.ScanTimingCost();
+    stats.times[Stats::ParsePhase] += total - stats.times[Stats::ScanPhase]
+                                            - stats.times[Stats::CheckPhase] - timing;
+    stats.times[Stats::ScanPhase] -= timing;
+    stats.counts[Stats::Diagnostics] = errors.NumErrors();
+    stats.units = 1;
+}
+
+/* The scanner records where each line starts as it passes the newline
+ * before it, so a line is available once scanning has reached it. The
+ * end of the line being scanned has not been seen yet and is searched
+ * for.
+ */
+const char *Context::GetLineNumbered(int num, int *length) {
+    if (num <= 0 || num > lineStarts.size()) return NULL;
+    const char *line = source.data() + lineStarts[num-1];
+    const char *end;
+    if (num < lineStarts.size()) {
+        end = source.data() + lineStarts[num] - 1;
+    } else {
+        end = line;
+        while (end < source.data() + sourceLength && SourceCharAt(end) != '\n')
+            end++;
+    }
+    *length = end - line;
+    return line;
+}
@@ -0,0 +1,92 @@
+/* File: context.h
+ * ---------------
+ * A Context holds the state that belongs to one translation unit while
+ * it is scanned and parsed. The scanner and parser used to keep this in
+ * globals (yylloc, yylval, the saved source lines and the line/column
+ * counters), which allowed only one parse per process at a time. The
+ * whole source is read into one buffer that flex scans in place, and
+ * lines are only recorded by their starting offsets. The
+ * reentrant scanner reaches its Context through yyextra and the pure
+ * parser receives it as an argument to yyparse, so separate translation
+ * units can be parsed on separate threads without any locking.
+ */
+
+#ifndef _H_context
+#define _H_context
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "location.h"
+#include "errors.h"
+#include "atom.h"
+#include "arena.h"
+#include "stats.h"
+
+using namespace std;
+
+class SymbolTable;
+class TypeTable;
+class TokenReader;
+class TokenRecorder;
+union YYSTYPE;
+
+class Context {
+  protected:
+    static thread_local Context *current;
+
+    void Init();
+    void RecordStats(Stats::Clock::duration total);
+
+  public:
+    void *scanner;                  // the reentrant scanner (a yyscan_t)
+    string source;                  // the input, then two NULs for flex
+    int sourceLength;               // bytes of input, without the NULs
+    vector<int> lineStarts;         // offset of each line, for error context
+    const char *heldPos;            // where flex has put a NUL in source
+    char heldChar;                  // and the character that belongs there
+    int curLineNum, curColNum;      // position of the next lexeme
+    AtomTable atoms;                // names of identifiers, interned
+    Arena arena;                    // the ast, freed with the context
+    SymbolTable *symtable;          // scopes seen by the semantic checks
+    TypeTable *types;               // the array and named types, one of each
+    ErrorSink errors;               // diagnostics reported for this unit
+    Stats stats;                    // recorded if Stats are enabled
+    TokenReader *tokenReader;       // if set, yylex replays it instead of scanning
+    TokenRecorder *tokenRecorder;   // if set, yylex records each token scanned
+
+    // Reads the whole translation unit from input and creates a scanner
+    // for it. Diagnostics are written to errorStream, or buffered in
+    // errors if it is NULL.
+    Context(FILE *input, ostream *errorStream = &cerr);
+    // Same, but scans a copy of source text that is already in memory
+    Context(const char *text, int length, ostream *errorStream = &cerr);
+    ~Context();
+
+    // Parses the whole input; semantic checking is started from the
+    // Program action once the parse succeeds. The context, its symbol
+    // table, its arena and its stats are current on this thread while it
+    // runs. Returns yyparse's result.
+    int Parse();
+
+    // Returns the next token as yylex does, with the context current so
+    // that errors are reported to it. For running the scanner without
+    // the parser.
+    int NextToken(YYSTYPE *value, yyltype *loc);
+
+    // Returns a pointer to the start of line num in the source buffer and
+    // sets *length to its length without the newline, or returns NULL if
+    // there is no such line. Read the characters with SourceCharAt.
+    const char *GetLineNumbered(int num, int *length);
+
+    // Returns the source character at p. While a token is being matched
+    // flex keeps a NUL just after it, so the buffer itself is off by
+    // one character there.
+    char SourceCharAt(const char *p) { return p == heldPos? heldChar : *p; }
+
+    // The context this thread is currently parsing, NULL between parses.
+    // Used by ReportError to find the source line of a diagnostic.
+    static Context *Current() { return current; }
+};
+
+#endif
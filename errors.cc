@@ -11,33 +11,54 @@
 
 using namespace std;
 
-#include "scanner.h" // for GetLineNumbered
+#include "context.h" // for GetLineNumbered
 #include "ast_type.h"
 #include "ast_expr.h"
 #include "ast_stmt.h"
 #include "ast_decl.h"
 
-int ReportError::numErrors = 0;
+void ErrorSink::Record(yyltype *loc, const string &msg) {
+    Diagnostic d;
+    d.line = loc? loc->first_line : 0;
+    d.firstColumn = loc? loc->first_column : 0;
+    d.lastColumn = loc? loc->last_column : 0;
+    d.message = msg;
+    diagnostics.push_back(d);
+}
+
+/* Errors reported while no Context is being parsed go straight to cerr.
+ */
+ErrorSink *ReportError::CurrentSink() {
+    static thread_local ErrorSink unattached(&cerr);
+    Context *ctx = Context::Current();
+    return ctx? &ctx->errors : &unattached;
+}
 
-void ReportError::UnderlineErrorInLine(const char *line, yyltype *pos) {
+void ReportError::UnderlineErrorInLine(ostream &out, Context *ctx, yyltype *pos) {
+    int length;
+    const char *line = ctx? ctx->GetLineNumbered(pos->first_line, &length) : NULL;
     if (!line) return;
-    cerr << line << endl;
+    for (int i = 0; i < length; i++)
+        out << ctx->SourceCharAt(line + i);
+    out << endl;
     for (int i = 1; i <= pos->last_column; i++)
-        cerr << (i >= pos->first_column ? '^' : ' ');
-    cerr << endl;
+        out << (i >= pos->first_column ? '^' : ' ');
+    out << endl;
 }
 
  
  
 void ReportError::OutputError(yyltype *loc, string msg) {
-    numErrors++;
+    ErrorSink *sink = CurrentSink();
+    ostream &out = sink->Stream();
+    sink->Record(loc, msg);
     fflush(stdout); // make sure any buffered text has been output
     if (loc) {
-        cerr << endl << "*** Error line " << loc->first_line << "." << endl;
-        UnderlineErrorInLine(GetLineNumbered(loc->first_line), loc);
+        out << endl << "*** Error line " << loc->first_line << "." << endl;
+        UnderlineErrorInLine(out, Context::Current(), loc);
     } else
-        cerr << endl << "*** Error." << endl;
-    cerr << "*** " << msg << endl << endl;
+        out << endl << "*** Error." << endl;
+    out << "*** " << msg << endl << endl;
 }
 
 
@@ -197,12 +218,20 @@ void ReportError::ContinueOutsideLoop(ContinueStmt *cStmt) {
  * -------------------
  * Standard error-reporting function expected by yacc. Our version merely
  * just calls into the error reporter above, passing the location of
- * the last token read. If you want to suppress the ordinary "parse error"
+ * the last token read, which the pure parser hands to us along with
+ * its parse parameters. If you want to suppress the ordinary "parse error"
  * message from yacc, you can implement yyerror to do nothing and
  * then call ReportError::Formatted yourself with a more descriptive 
  * message.
  */
 
+void yyerror(yyltype *loc, Context *ctx, void *scanner, const char *msg) {
+    ReportError::Formatted(loc, "%s", msg);
+}
+
+/* The one-argument form is still declared by the AST headers; outside of
+ * the parser there is no current token, so no location is reported.
+ */
 void yyerror(const char *msg) {
-    ReportError::Formatted(&yylloc, "%s", msg);
+    ReportError::Formatted(NULL, "%s", msg);
 }
@@ -14,6 +14,9 @@
 #define _errors_h_
 
 #include <string>
+#include <sstream>
+#include <iostream>
+#include <vector>
 #include "location.h"
 #include "ast_decl.h"
 
@@ -41,6 +44,7 @@ using namespace std;
  * as an argument. You cannot pass NULL for these arguments.
  */
 
+class Context;
 class Type;
 class Identifier;
 class Expr;
@@ -50,6 +54,39 @@ class ReturnStmt;
 class Decl;
 class Operator;
 
+/**
+ * Class: ErrorSink
+ * ----------------
+ * Receives the diagnostics for one translation unit and counts them.
+ * Every Context owns a sink and ReportError writes to the sink of the
+ * current Context, so files checked on different threads keep separate
+ * counts. A sink either passes its text straight through to a stream
+ * or, given no stream, holds it until the driver prints it, which is
+ * how parallel checking keeps the output in input order. Each error is
+ * also kept as a Diagnostic for clients that want the fields rather
+ * than the formatted text, such as the server.
+ */
+struct Diagnostic {
+  int line, firstColumn, lastColumn;   // all 0 if there is no location
+  string message;
+};
+
+class ErrorSink {
+ public:
+  ErrorSink(ostream *out = NULL) : out(out) {}
+
+  ostream &Stream()        { return out? *out : buffered; }
+  string BufferedText()    { return buffered.str(); }
+  int NumErrors()          { return diagnostics.size(); }
+  void Record(yyltype *loc, const string &msg);
+
+  vector<Diagnostic> diagnostics;
+
+ private:
+  ostream *out;
+  ostringstream buffered;
+};
+
 typedef enum {
       LookingForType,
       LookingForVariable,
@@ -103,12 +140,12 @@ class ReportError {
   static void Formatted(yyltype *loc, const char *format, ...);
 
 
-  // Returns number of error messages printed
-  static int NumErrors() { return numErrors; }
+  // Returns number of error messages printed for the current file
+  static int NumErrors() { return CurrentSink()->NumErrors(); }
   
  private:
-  static void UnderlineErrorInLine(const char *line, yyltype *pos);
+  static ErrorSink *CurrentSink();
+  static void UnderlineErrorInLine(ostream &out, Context *ctx, yyltype *pos);
   static void OutputError(yyltype *loc, string msg);
-  static int numErrors;
 };
 #endif
@@ -0,0 +1,116 @@
+/* File: keywords.h
+ * ----------------
+ * Keyword recognition for the scanner. Rather than giving each keyword
+ * and type name a flex rule of its own, which makes the DFA many times
+ * bigger, the scanner matches every word with the one identifier rule
+ * and then looks the word up here.
+ *
+ * The lookup is a perfect hash: the hash of each keyword lands in a slot
+ * of its own, so a word is a keyword exactly when it matches the one
+ * keyword whose slot it hashes to. The hash seed that makes this true is
+ * found by the compiler, which tries seeds until no two keywords share a
+ * slot, so adding a keyword to the list is all it takes. The slot table
+ * is 128 bytes.
+ */
+
+#ifndef _H_keywords
+#define _H_keywords
+
+#include <string.h>
+#include "parser.h"     // for the token codes
+
+struct Keyword {
+    const char *name;
+    int length;
+    int token;
+};
+
+static constexpr int KeywordLength(const char *s) {
+    int n = 0;
+    while (s[n]) n++;
+    return n;
+}
+
+#define KEYWORD(name, token) { name, KeywordLength(name), token }
+
+static constexpr Keyword keywords[] = {
+    KEYWORD("void", T_Void),        KEYWORD("int", T_Int),
+    KEYWORD("float", T_Float),      KEYWORD("bool", T_Bool),
+    KEYWORD("while", T_While),      KEYWORD("for", T_For),
+    KEYWORD("if", T_If),            KEYWORD("else", T_Else),
+    KEYWORD("return", T_Return),    KEYWORD("break", T_Break),
+    KEYWORD("switch", T_Switch),    KEYWORD("case", T_Case),
+    KEYWORD("default", T_Default),  KEYWORD("const", T_Const),
+    KEYWORD("uniform", T_Uniform),  KEYWORD("continue", T_Continue),
+    KEYWORD("do", T_Do),            KEYWORD("in", T_In),
+    KEYWORD("out", T_Out),
+    KEYWORD("mat2", T_Mat2),        KEYWORD("mat3", T_Mat3),
+    KEYWORD("mat4", T_Mat4),        KEYWORD("vec2", T_Vec2),
+    KEYWORD("vec3", T_Vec3),        KEYWORD("vec4", T_Vec4),
+    KEYWORD("ivec2", T_Ivec2),      KEYWORD("ivec3", T_Ivec3),
+    KEYWORD("ivec4", T_Ivec4),      KEYWORD("bvec2", T_Bvec2),
+    KEYWORD("bvec3", T_Bvec3),      KEYWORD("bvec4", T_Bvec4),
+    KEYWORD("uint", T_Uint),        KEYWORD("uvec2", T_Uvec2),
+    KEYWORD("uvec3", T_Uvec3),      KEYWORD("uvec4", T_Uvec4),
+};
+
+#undef KEYWORD
+
+static const int NumKeywords = sizeof(keywords) / sizeof(keywords[0]);
+static const int KeywordSlotBits = 7;
+static const int NumKeywordSlots = 1 << KeywordSlotBits;
+
+static constexpr int LongestKeyword() {
+    int longest = 0;
+    for (int i = 0; i < NumKeywords; i++)
+        if (keywords[i].length > longest) longest = keywords[i].length;
+    return longest;
+}
+
+// FNV-1a from a seeded basis, mixed so that the top bits, which pick
+// the slot, depend on every character
+static constexpr unsigned KeywordHash(unsigned seed, const char *s, int length) {
+    unsigned h = 2166136261u ^ seed;
+    for (int i = 0; i < length; i++)
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h >> (32 - KeywordSlotBits);
+}
+
+struct KeywordSlots {
+    unsigned seed;
+    bool found;
+    unsigned char slot[NumKeywordSlots];    // index in keywords + 1, or 0
+};
+
+static constexpr KeywordSlots FindKeywordSlots() {
+    for (unsigned seed = 0; seed < 10000; seed++) {
+        KeywordSlots table = { seed, true, {} };
+        for (int i = 0; i < NumKeywords && table.found; i++) {
+            unsigned s = KeywordHash(seed, keywords[i].name, keywords[i].length);
+            if (table.slot[s] != 0) table.found = false;
+            table.slot[s] = i + 1;
+        }
+        if (table.found) return table;
+    }
+    return KeywordSlots();
+}
+
+static constexpr KeywordSlots keywordSlots = FindKeywordSlots();
+static_assert(keywordSlots.found, "no perfect hash seed for the keywords");
+
+static const int MaxKeywordLength = LongestKeyword();
+
+// Returns the token code for the first length characters of text if
+// they are a keyword, 0 if they are not
+static inline int KeywordToken(const char *text, int length) {
+    if (length > MaxKeywordLength) return 0;
+    int k = keywordSlots.slot[KeywordHash(keywordSlots.seed, text, length)];
+    if (k == 0) return 0;
+    const Keyword &kw = keywords[k - 1];
+    return (kw.length == length && memcmp(kw.name, text, length) == 0)? kw.token : 0;
+}
+
+#endif
@@ -0,0 +1,338 @@
+/* File: lexbench.cc
+ * -----------------
+ * A benchmark for the scanner on its own: it runs yylex over each input
+ * until the end and reports how fast it went, in megabytes and in tokens
+ * per second, taking the best of several runs. The inputs are the files
+ * named on the command line, or, with none, synthetic sources generated
+ * here that lean on particular parts of the scanner.
+ *
+ * Diagnostics from the scanner are kept with each input's Context and
+ * not printed. With --dump it prints the token stream of each input
+ * instead: the token code, location and value of every token. Scanners
+ * built from different versions of scanner.l must produce the same
+ * dump, and so must one scanner whatever --simd width it skips blanks
+ * and comments at (32, 16, or 0 for a byte at a time; by default the
+ * widest the CPU has), and so must a replay of the stream recorded for
+ * the token cache (see tokens.h). --check scans each input a byte at a
+ * time and at every width the CPU has, replays it, and fails if the
+ * token streams differ. With --tokens the benchmark times replaying
+ * each input's recorded stream instead of scanning it.
+ *
+ * Usage: lexbench [--repeat N] [--dump | --check] [--simd W | --tokens] [file ...]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "parser.h"
+#include "context.h"
+#include "tokens.h"
+#include "utility.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+struct Input {
+    string name;
+    string text;
+};
+
+/* Function: WordsSource()
+ * -----------------------
+ * Declarations made almost entirely of keywords, type names and
+ * identifiers that look like them, for keyword recognition.
+ */
+static string WordsSource(int lines)
+{
+    static const char *words[] = {
+        "float", "vec3", "uvec4", "position", "voidness", "in", "index",
+        "do", "done", "const", "constant", "mat4", "matrix", "uniform",
+        "bvec2", "ivec3", "return", "returned", "int", "interior",
+        "while", "whilst", "switch", "default", "defaults", "else"
+    };
+    const int numWords = sizeof(words) / sizeof(words[0]);
+    string s;
+    for (int i = 0; i < lines; i++) {
+        for (int j = 0; j < 8; j++) {
+            s += words[(i * 7 + j * 3) % numWords];
+            s += ' ';
+        }
+        s += ";\n";
+    }
+    return s;
+}
+
+/* Function: IdentifiersSource()
+ * -----------------------------
+ * Assignments between long names, many of them longer than MaxIdentLen,
+ * for the identifier rule and interning.
+ */
+static string IdentifiersSource(int lines)
+{
+    static const char *parts[] = {
+        "light", "position", "world", "space", "normal", "matrix",
+        "diffuse", "specular", "shadow", "cascade", "texture", "offset"
+    };
+    const int numParts = sizeof(parts) / sizeof(parts[0]);
+    string s;
+    for (int i = 0; i < lines; i++) {
+        for (int side = 0; side < 2; side++) {
+            int words = 2 + (i + side) % 7;
+            for (int j = 0; j < words; j++) {
+                if (j > 0) s += '_';
+                s += parts[(i * 5 + j * 7 + side) % numParts];
+            }
+            s += (side == 0)? " = " : ";\n";
+        }
+    }
+    return s;
+}
+
+/* Function: OperatorsSource()
+ * ---------------------------
+ * Expressions with an operator between every pair of single letter
+ * operands and no spaces, for the operator rules.
+ */
+static string OperatorsSource(int lines)
+{
+    static const char *ops[] = {
+        "+", "-", "*", "/", "<", ">", "<=", ">=", "==", "!=", "&&", "||"
+    };
+    static const char *assigns[] = { "=", "+=", "-=", "*=", "/=" };
+    const int numOps = sizeof(ops) / sizeof(ops[0]);
+    string s;
+    for (int i = 0; i < lines; i++) {
+        s += char('a' + i % 26);
+        s += assigns[i % 5];
+        for (int j = 0; j < 12; j++) {
+            if (j % 4 == 1) s += "-";
+            s += char('a' + (i + j) % 26);
+            if (j % 5 == 2) s += "++";
+            s += ops[(i * 3 + j) % numOps];
+        }
+        s += "z;\n";
+    }
+    return s;
+}
+
+/* Function: CommentsSource()
+ * --------------------------
+ * License blocks, // commentary and indentation around a little code,
+ * as generated shaders tend to be, for skipping blanks and comments.
+ */
+static string CommentsSource(int blocks)
+{
+    string s;
+    for (int i = 0; i < blocks; i++) {
+        s += "/*\n";
+        for (int j = 0; j < 12; j++)
+            s += " * Licensed under the terms of the license in this block;\t"
+                 "you may not use this file except in compliance.\n";
+        s += " */\n\n";
+        for (int j = 0; j < 4; j++) {
+            s += "        // ";
+            s += string(60 + j * 10, '-');
+            s += "\n        \t\n";
+        }
+        s += "        float value;   /* inline */   // and a trailer\n\n\n";
+    }
+    return s;
+}
+
+/* Function: Record()
+ * ------------------
+ * Scans text and returns its encoded token stream, or an empty string if
+ * the scan cannot be stored because of a lexical error.
+ */
+static string Record(const string &text)
+{
+    Context ctx(text.data(), text.size(), NULL);
+    TokenRecorder recorder;
+    ctx.tokenRecorder = &recorder;
+    YYSTYPE value;
+    yyltype loc;
+    while (ctx.NextToken(&value, &loc) != 0)
+        ;
+    return recorder.IsUsable()? recorder.Encode(ctx.sourceLength) : "";
+}
+
+/* Function: ScanAll()
+ * -------------------
+ * Scans text from start to finish, or replays stream if it is not NULL,
+ * and returns the number of tokens, appending each of them to dump if it
+ * is not NULL.
+ */
+static long ScanAll(const string &text, string *dump, const string *stream = NULL)
+{
+    Context ctx(text.data(), text.size(), NULL);
+    TokenReader reader;
+    if (stream) {
+        if (!reader.Open(stream->data(), stream->size(), &ctx))
+            Failure("Cannot open a recorded token stream");
+        ctx.tokenReader = &reader;
+    }
+    YYSTYPE value;
+    yyltype loc;
+    long count = 0;
+    int token;
+    char line[64];
+    while ((token = ctx.NextToken(&value, &loc)) != 0) {
+        count++;
+        if (!dump) continue;
+        snprintf(line, sizeof(line), "%d %d.%d-%d", token, loc.first_line, loc.first_column, loc.last_column);
+        *dump += line;
+        if (token == T_Identifier || token == T_FieldSelection) {
+            *dump += ' ';
+            *dump += value.atom;
+        } else if (token == T_IntConstant) {
+            snprintf(line, sizeof(line), " %d", value.integerConstant);
+            *dump += line;
+        } else if (token == T_FloatConstant) {
+            snprintf(line, sizeof(line), " %g", value.floatConstant);
+            *dump += line;
+        } else if (token == T_BoolConstant) {
+            snprintf(line, sizeof(line), " %d", value.boolConstant);
+            *dump += line;
+        }
+        *dump += '\n';
+    }
+    return count;
+}
+
+/* Function: Compare()
+ * -------------------
+ * Returns whether the dump other is the same as expected, first printing
+ * the first token where it is not.
+ */
+static bool Compare(const Input &in, const string &expected, const string &other,
+                    const char *otherName)
+{
+    if (expected == other)
+        return true;
+    size_t i = 0;
+    while (expected[i] == other[i]) i++;
+    size_t start = expected.rfind('\n', i);
+    start = (start == string::npos)? 0 : start + 1;
+    long token = count(expected.begin(), expected.begin() + start, '\n') + 1;
+    printf("%-28s differs at token %ld:\n  scalar:  %s\n  %-8s %s\n", in.name.c_str(), token,
+           expected.substr(start, expected.find('\n', start) - start).c_str(), otherName,
+           other.substr(start, other.find('\n', start) - start).c_str());
+    return false;
+}
+
+/* Function: Check()
+ * -----------------
+ * Scans the input a byte at a time and then at each SIMD width the CPU
+ * has, and replays its recorded token stream unless it has lexical
+ * errors, and reports whether all the token streams are the same.
+ */
+static bool Check(const Input &in)
+{
+    static const struct { int width; const char *name; } widths[] = {
+        { 16, "sse2:" }, { 32, "avx2:" }
+    };
+    string scalar, replayed;
+    SetScannerSimd(0);
+    long tokens = ScanAll(in.text, &scalar);
+    for (int i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        if (SetScannerSimd(widths[i].width) != widths[i].width) continue;
+        string dump;
+        ScanAll(in.text, &dump);
+        if (!Compare(in, scalar, dump, widths[i].name))
+            return false;
+    }
+    string stream = Record(in.text);
+    if (stream.empty()) {
+        printf("%-28s %10ld tokens identical, not recorded\n", in.name.c_str(), tokens);
+        return true;
+    }
+    ScanAll(in.text, &replayed, &stream);
+    if (!Compare(in, scalar, replayed, "replay:"))
+        return false;
+    printf("%-28s %10ld tokens identical\n", in.name.c_str(), tokens);
+    return true;
+}
+
+static void Benchmark(const Input &in, int repeat, bool replay)
+{
+    string stream;
+    if (replay && (stream = Record(in.text)).empty()) {
+        printf("%-28s not recorded\n", in.name.c_str());
+        return;
+    }
+    long tokens = 0;
+    double best = 0;
+    for (int i = 0; i < repeat; i++) {
+        Clock::time_point start = Clock::now();
+        tokens = ScanAll(in.text, NULL, replay? &stream : NULL);
+        double secs = chrono::duration<double>(Clock::now() - start).count();
+        if (i == 0 || secs < best) best = secs;
+    }
+    if (best <= 0) best = 1e-9;
+    printf("%-28s %10.1f KB %10ld tokens %9.1f MB/s %12.0f tokens/s\n",
+           in.name.c_str(), in.text.size() / 1024.0, tokens,
+           in.text.size() / best / 1e6, tokens / best);
+}
+
+int main(int argc, char *argv[])
+{
+    int repeat = 5;
+    int simd = 32;
+    bool dump = false, check = false, replay = false;
+    vector<Input> inputs;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dump") == 0) {
+            dump = true;
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            simd = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tokens") == 0) {
+            replay = true;
+        } else {
+            FILE *fp = fopen(argv[i], "r");
+            if (!fp) Failure("Cannot open %s", argv[i]);
+            Input in;
+            in.name = argv[i];
+            ReadWholeFile(fp, &in.text);
+            fclose(fp);
+            inputs.push_back(in);
+        }
+    }
+    if (inputs.empty()) {
+        Input synthetic[] = {
+            { "words", WordsSource(20000) },
+            { "identifiers", IdentifiersSource(10000) },
+            { "operators", OperatorsSource(20000) },
+            { "comments", CommentsSource(1000) }
+        };
+        inputs.assign(synthetic, synthetic + sizeof(synthetic) / sizeof(synthetic[0]));
+    }
+
+    InitParser();
+    int widest = SetScannerSimd(32);
+    simd = SetScannerSimd(simd);
+    if (check)
+        printf("checking SIMD widths up to %d bytes against a byte at a time\n", widest);
+    else if (!dump && !replay)
+        printf("skipping %d bytes at a time\n", simd);
+    bool same = true;
+    for (int i = 0; i < inputs.size(); i++) {
+        if (check) {
+            same = Check(inputs[i]) && same;
+        } else if (dump) {
+            string tokens;
+            ScanAll(inputs[i].text, &tokens);
+            printf("== %s\n%s", inputs[i].name.c_str(), tokens.c_str());
+        } else {
+            Benchmark(inputs[i], repeat < 1? 1 : repeat, replay);
+        }
+    }
+    return same? 0 : 1;
+}
@@ -3,8 +3,13 @@
  * ------------
  * Simple list class for storing a linear collection of elements. It
  * supports operations similar in name to the CS107 CVector -- nth, insert,
- * append, remove, etc.  This class is nothing more than a very thin
- * cover of a STL deque, with some added range-checking. Given not everyone
+ * append, remove, etc.  This class is a small vector with some added
+ * range-checking: the first few elements are stored inside the List
+ * itself, which is all most of the lists built by the parser ever need,
+ * and longer lists move to a contiguous array. Lists, and those arrays,
+ * are allocated from the current arena like the ast nodes they hold
+ * (see arena.h), so elements must be simple values such as pointers or
+ * numbers that need no destructor. Given not everyone
  * is familiar with the C++ templates, this class provides a more familiar
  * interface.
  *
@@ -23,13 +28,19 @@
  *       }
  *       return sum;
  *    }
+ *
+ * or, visiting the elements in order with a range-based for loop,
+ *
+ *       for (int val : *list)
+ *          sum += val;
  */
 
 #ifndef _H_list
 #define _H_list
 
-#include <deque>
+#include <stdlib.h>
 #include "utility.h"  // for Assert()
+#include "arena.h"
 using namespace std;
 
 class Node;
@@ -37,19 +48,46 @@ class Node;
 template<class Element> class List {
 
  private:
-    deque<Element> elems;
+    static const int InlineCapacity = 4;
+
+    Element *elems;         // inlineElems until the list outgrows it
+    int numElems, capacity;
+    Arena *arena;           // where a larger array comes from, NULL for heap
+    Element inlineElems[InlineCapacity];
+
+    void Grow()
+	{ int newCapacity = capacity * 2;
+	  size_t size = newCapacity * sizeof(Element);
+	  Element *newElems = (Element *)(arena? arena->Allocate(size) : malloc(size));
+	  if (!newElems) Failure("Out of memory!");
+	  for (int i = 0; i < numElems; i++)
+	    newElems[i] = elems[i];
+	  FreeElems();
+	  elems = newElems;
+	  capacity = newCapacity; }
+
+    void FreeElems()
+	{ if (!arena && elems != inlineElems) free(elems); }
+
+    List(const List &);             // not copyable: elems may point
+    List &operator=(const List &);  // into the list itself
 
  public:
            // Create a new empty list
-    List() {}
+    List() : elems(inlineElems), numElems(0), capacity(InlineCapacity),
+             arena(Arena::Current()) {}
+    ~List() { FreeElems(); }
+
+    static void *operator new(size_t size) { return Arena::AllocateCurrent(size); }
+    static void operator delete(void *p)   {}
 
            // Returns count of elements currently in list
     int NumElements() const
-	{ return elems.size(); }
+	{ return numElems; }
 
           // Returns element at index in list. Indexing is 0-based.
           // Raises an assert if index is out of range.
-    Element Nth(int index) const
+    const Element &Nth(int index) const
 	{ Assert(index >= 0 && index < NumElements());
 	  return elems[index]; }
 
@@ -57,17 +95,30 @@ template<class Element> class List {
           // Raises assert if index out of range
     void InsertAt(const Element &elem, int index)
 	{ Assert(index >= 0 && index <= NumElements());
-	  elems.insert(elems.begin() + index, elem); }
+	  if (numElems == capacity) Grow();
+	  for (int i = numElems; i > index; i--)
+	    elems[i] = elems[i-1];
+	  elems[index] = elem;
+	  numElems++; }
 
           // Adds element to list end
     void Append(const Element &elem)
-	{ elems.push_back(elem); }
+	{ if (numElems == capacity) Grow();
+	  elems[numElems++] = elem; }
 
          // Removes element at index, shuffling down others
          // Raises assert if index out of range
     void RemoveAt(int index)
 	{ Assert(index >= 0 && index < NumElements());
-	  elems.erase(elems.begin() + index); }
+	  for (int i = index; i < numElems - 1; i++)
+	    elems[i] = elems[i+1];
+	  numElems--; }
+
+         // Iteration over the elements in order, for range-based for loops
+    Element *begin()             { return elems; }
+    Element *end()               { return elems + numElems; }
+    const Element *begin() const { return elems; }
+    const Element *end() const   { return elems + numElems; }
           
        // These are some specific methods useful for lists of ast nodes
        // They will only work on lists of elements that respond to the
@@ -75,14 +126,13 @@ template<class Element> class List {
        // you can still have Lists of ints, chars*, as long as you 
        // don't try to SetParentAll on that list.
     void SetParentAll(Node *p)
-        { for (int i = 0; i < NumElements(); i++)
-             Nth(i)->SetParent(p); }
+        { for (Element e : *this)
+             e->SetParent(p); }
     void PrintAll(int indentLevel, const char *label = NULL)
-        { for (int i = 0; i < NumElements(); i++)
-             Nth(i)->Print(indentLevel, label); }
+        { for (Element e : *this)
+             e->Print(indentLevel, label); }
              
 
 };
 
 #endif
-
@@ -2,9 +2,10 @@
  * ----------------
  * This file just contains features relative to the location structure
  * used to record the lexical position of a token or symbol.  This file
- * establishes the cmoon definition for the yyltype structure, the global
- * variable yylloc, and a utility function to join locations you might
- * find handy at times.
+ * establishes the cmoon definition for the yyltype structure and a
+ * utility function to join locations you might find handy at times.
+ * There is no global yylloc: the parser is pure, so the location of the
+ * lexeme just scanned is passed to yylex by pointer for each token.
  */
 
 #ifndef YYLTYPE
@@ -23,14 +24,9 @@ typedef struct yyltype
 } yyltype;
 
 #define YYLTYPE yyltype
-
-
-/* Global variable: yylloc
- * ------------------------
- * The global variable holding the position information about the
- * lexeme just scanned.
- */
-extern struct yyltype yylloc;
+// A plain struct, so the parser may move its stacks when they grow;
+// without this a C++ parser stops at a fixed depth of 200
+#define YYLTYPE_IS_TRIVIAL 1
 
 
 /* Function: Join
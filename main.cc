@@ -1,30 +1,246 @@
 /* File: main.cc
  * -------------
  * This file defines the main() routine for the program and not much else.
- * You should not need to modify this file.
+ * With no file arguments it checks a single shader read from stdin; given
+ * a list of files it checks each of them in the same process, spreading
+ * them across several threads when asked to with -j. With --serve it
+ * hands over to the server in server.cc.
  */
- 
+
 #include <string.h>
 #include <stdio.h>
+#include <mutex>
 #include "utility.h"
 #include "errors.h"
 #include "parser.h"
+#include "context.h"
+#include "threadpool.h"
+#include "server.h"
+#include "cache.h"
+#include "tokens.h"
+#include "trace.h"
+
+
+/* Struct: FileResult
+ * ------------------
+ * The outcome of checking one file in batch mode. When files are checked
+ * in parallel the diagnostics are held here until every earlier file has
+ * been reported, so the output is the same whatever the thread count.
+ */
+struct FileResult {
+    int numErrors;
+    string diagnostics;
+    Stats stats;
+    bool done;
+
+    FileResult() : numErrors(0), done(false) {}
+};
+
+
+/* Function: Parse()
+ * -----------------
+ * Parses and checks ctx, through the token cache if there is one.
+ */
+static void Parse(Context *ctx, TokenCache *tokens)
+{
+    if (tokens)
+        tokens->Parse(ctx);
+    else
+        ctx->Parse();
+}
+
+
+/* Function: CheckCached()
+ * -----------------------
+ * Checks the whole contents of fp through the result cache: a hit
+ * replays the stored result without parsing at all, and a miss checks
+ * the source and stores what was found. The diagnostics go to
+ * errorStream, or are left in result->diagnostics if it is NULL.
+ */
+static void CheckCached(FILE *fp, ResultCache *cache, TokenCache *tokens,
+                        ostream *errorStream, FileResult *result)
+{
+    string source;
+    ReadWholeFile(fp, &source);
+    if (!cache->Lookup(source, &result->numErrors, &result->diagnostics)) {
+        Context ctx(source.data(), source.size(), NULL);
+        Parse(&ctx, tokens);
+        result->numErrors = ctx.errors.NumErrors();
+        result->diagnostics = ctx.errors.BufferedText();
+        result->stats = ctx.stats;
+        cache->Store(source, result->numErrors, result->diagnostics);
+    }
+    if (errorStream) {
+        *errorStream << result->diagnostics;
+        result->diagnostics.clear();
+    }
+}
+
+
+/* Function: CheckFile()
+ * ---------------------
+ * Runs the scanner, parser and semantic analyzer over one shader file.
+ * Each file gets its own Context, with its own scanner, symbol table and
+ * error sink, so every file is checked as if by a fresh process. The
+ * diagnostics go to errorStream, or into result->diagnostics if it is
+ * NULL. cache and tokens may be NULL if those caches are off.
+ */
+static void CheckFile(const char *name, ResultCache *cache, TokenCache *tokens,
+                      ostream *errorStream, FileResult *result)
+{
+    FILE *fp = fopen(name, "r");
+    if (!fp) {
+        string msg = string("\n*** Cannot open ") + name + "\n\n";
+        if (errorStream) *errorStream << msg;
+        else result->diagnostics = msg;
+        result->numErrors = 1;
+        return;
+    }
+    if (cache) {
+        CheckCached(fp, cache, tokens, errorStream, result);
+    } else {
+        Context ctx(fp, errorStream);
+        Parse(&ctx, tokens);
+        result->numErrors = ctx.errors.NumErrors();
+        result->stats = ctx.stats;
+        if (!errorStream)
+            result->diagnostics = ctx.errors.BufferedText();
+    }
+    fclose(fp);
+}
+
+
+/* Function: PrintStatus()
+ * -----------------------
+ * Prints the status line for one file in batch mode.
+ */
+static void PrintStatus(const char *name, int errors)
+{
+    if (errors == 0)
+        printf("%s: ok\n", name);
+    else
+        printf("%s: %d error%s\n", name, errors, errors == 1? "" : "s");
+    fflush(stdout);
+}
+
+
+/* Function: ReportStats()
+ * -----------------------
+ * Prints the stats of the run for -d stats and writes them to the
+ * --stats-json file, if either was asked for, and writes the --trace
+ * file.
+ */
+static void ReportStats(DriverOptions *options, Stats *stats)
+{
+    if (options->traceFile && !Trace::Write(options->traceFile))
+        fprintf(stderr, "Cannot write trace to %s\n", options->traceFile);
+    if (IsDebugOn("stats"))
+        stats->Print(stdout);
+    if (options->statsFile) {
+        FILE *fp = fopen(options->statsFile, "w");
+        if (!fp) {
+            fprintf(stderr, "Cannot write stats to %s\n", options->statsFile);
+            return;
+        }
+        stats->PrintJSON(fp);
+        fclose(fp);
+    }
+}
+
+
+/* Function: CheckInParallel()
+ * ---------------------------
+ * Checks all the input files on a pool of threads. Whichever thread
+ * finishes a file also prints every result that is now next in input
+ * order, so output streams out while the rest are still being checked.
+ */
+static void CheckInParallel(DriverOptions *options, ResultCache *cache,
+                            TokenCache *tokens, vector<FileResult> &results)
+{
+    mutex outputLock;
+    int nextToPrint = 0;
+    int count = options->inputFiles.size();
+
+    ThreadPool pool(options->numThreads);
+    pool.ForEach(count, [&](int i) {
+        FileResult result;
+        CheckFile(options->inputFiles[i], cache, tokens, NULL, &result);
+
+        lock_guard<mutex> guard(outputLock);
+        results[i] = result;
+        results[i].done = true;
+        while (nextToPrint < count && results[nextToPrint].done) {
+            FileResult &r = results[nextToPrint];
+            cerr << r.diagnostics << flush;
+            PrintStatus(options->inputFiles[nextToPrint], r.numErrors);
+            r.diagnostics.clear();
+            nextToPrint++;
+        }
+    });
+}
 
 
 /* Function: main()
  * ----------------
  * Entry point to the entire program.  We parse the command line and turn
  * on any debugging flags requested by the user when invoking the program.
- * InitScanner() is used to set up the scanner.
- * InitParser() is used to set up the parser. The call to yyparse() will
- * attempt to parse a complete program from the input. 
+ * InitParser() is used to set up the parser. Each Context sets up its own
+ * scanner, and Context::Parse() will attempt to parse a complete program
+ * from its input.
+ * In batch mode a status line is printed for each file, followed by a
+ * summary of the whole run.
  */
 int main(int argc, char *argv[])
 {
-    ParseCommandLine(argc, argv);
-    InitScanner();
+    DriverOptions options;
+    ParseCommandLine(argc, argv, &options);
+    // the trace shows the scan time of each unit, so needs the stats too
+    if (IsDebugOn("stats") || options.statsFile || options.traceFile)
+        Stats::Enable();
+    if (options.traceFile)
+        Trace::Enable();
     InitParser();
-    yyparse();
-    return (ReportError::NumErrors() == 0? 0 : -1);
-}
+    if (options.serve)
+        return Serve(&options);
+    ResultCache *cache = options.cacheDir? new ResultCache(options.cacheDir) : NULL;
+    TokenCache *tokens = options.tokenCacheDir? new TokenCache(options.tokenCacheDir) : NULL;
+    if (options.inputFiles.empty()) {
+        FileResult result;
+        if (cache) {
+            CheckCached(stdin, cache, tokens, &cerr, &result);
+        } else {
+            Context ctx(stdin);
+            Parse(&ctx, tokens);
+            result.numErrors = ctx.errors.NumErrors();
+            result.stats = ctx.stats;
+        }
+        ReportStats(&options, &result.stats);
+        return (result.numErrors == 0? 0 : -1);
+    }
 
+    int count = options.inputFiles.size();
+    vector<FileResult> results(count);
+    if (options.numThreads > 1 && count > 1) {
+        CheckInParallel(&options, cache, tokens, results);
+    } else {
+        for (int i = 0; i < count; i++) {
+            CheckFile(options.inputFiles[i], cache, tokens, &cerr, &results[i]);
+            PrintStatus(options.inputFiles[i], results[i].numErrors);
+        }
+    }
+
+    int numFailed = 0, totalErrors = 0;
+    Stats totals;
+    for (int i = 0; i < count; i++) {
+        totals.Add(results[i].stats);
+        if (results[i].numErrors > 0) {
+            numFailed++;
+            totalErrors += results[i].numErrors;
+        }
+    }
+    printf("%d file%s checked, %d passed, %d failed, %d error%s\n",
+           count, count == 1? "" : "s", count - numFailed, numFailed,
+           totalErrors, totalErrors == 1? "" : "s");
+    ReportStats(&options, &totals);
+    return (numFailed == 0? 0 : -1);
+}
@@ -0,0 +1,10 @@
+int x[3];
+float f(int a) { return 1.0; }
+void main() {
+  float y;
+  int z[3];
+  y = x[0] + 1.0;
+  y = f(y);
+  z = x;
+  while (y) { break; }
+}
@@ -32,7 +32,7 @@
 #include "y.tab.h"              
 #endif
 
-int yyparse();              // Defined in the generated y.tab.c file
+int yyparse(Context *ctx, void *scanner); // Defined in the generated y.tab.c file
 void InitParser();          // Defined in parser.y
 
 #endif
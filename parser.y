@@ -19,11 +19,32 @@
 #include "scanner.h" // for yylex
 #include "parser.h"
 #include "errors.h"
+#include "context.h"
+#include "pass.h"
+#include "trace.h"
 
-void yyerror(const char *msg); // standard error-handling routine
+/* The parser's stacks grow on the heap as needed (see location.h); let
+ * them grow far enough for machine-generated shaders with deeply nested
+ * parentheses or long chains of right-associative assignments. */
+#define YYMAXDEPTH 1000000
+
+void yyerror(yyltype *loc, Context *ctx, void *scanner, const char *msg);
 
 %}
 
+/* Pure parser
+ * -----------
+ * yylval and yylloc are locals of yyparse rather than globals, and the
+ * scanner handle is passed down to yylex, so that each translation unit
+ * is parsed with its own Context. yyerror receives the same arguments
+ * as yyparse along with the location of the offending token.
+ */
+%define api.pure
+%locations
+%parse-param {Context *ctx}
+%parse-param {void *scanner}
+%lex-param   {void *scanner}
+
 /* The section before the first %% is the Definitions section of the yacc
  * input file. Here is where you declare tokens and types, add precedence
  * and associativity options, and so on.
@@ -42,7 +63,8 @@ void yyerror(const char *msg); // standard error-handling routine
     int integerConstant;
     bool boolConstant;
     double floatConstant;
-    char identifier[MaxIdentLen+1]; // +1 for terminating null
+    Atom atom;
+    opcodeT opcode;
     Decl *decl;
     FnDecl *funcDecl;
     List<Decl*> *declList;
@@ -75,17 +97,17 @@ void yyerror(const char *msg); // standard error-handling routine
 %token   T_LeftParen T_RightParen T_LeftBracket T_RightBracket T_LeftBrace T_RightBrace
 %token   T_Dot T_Comma T_Colon T_Semicolon T_Question
 
-%token   <identifier> T_LessEqual T_GreaterEqual T_EQ T_NE
-%token   <identifier> T_And T_Or 
-%token   <identifier> T_Plus T_Star
-%token   <identifier> T_MulAssign T_DivAssign T_AddAssign T_SubAssign T_Equal
-%token   <identifier> T_LeftAngle T_RightAngle T_Dash T_Slash
-%token   <identifier> T_Inc T_Dec 
-%token   <identifier> T_Identifier
+%token   <opcode> T_LessEqual T_GreaterEqual T_EQ T_NE
+%token   <opcode> T_And T_Or 
+%token   <opcode> T_Plus T_Star
+%token   <opcode> T_MulAssign T_DivAssign T_AddAssign T_SubAssign T_Equal
+%token   <opcode> T_LeftAngle T_RightAngle T_Dash T_Slash
+%token   <opcode> T_Inc T_Dec 
+%token   <atom> T_Identifier
 %token   <integerConstant> T_IntConstant
 %token   <floatConstant> T_FloatConstant
 %token   <boolConstant> T_BoolConstant
-%token   <identifier> T_FieldSelection
+%token   <atom> T_FieldSelection
 
 %nonassoc LOWEST
 %nonassoc LOWER_THAN_ELSE
@@ -138,12 +160,25 @@ Program   :    DeclList            {
                                        * yacc to set up yylloc. You can remove 
                                        * it once you have other uses of @n*/
                                       Program *program = new Program($1);
-                                      // if no errors, advance to next phase
+                                      // if no errors, advance to next phase;
+                                      // the checking passes share one walk
                                       if (ReportError::NumErrors() == 0) {
+                                          PassManager passes;
+                                          PrintPass printer;
+                                          TracePass tracer;
+                                          ResolvePass resolver;
+                                          CheckPass checker;
                                           if ( IsDebugOn("dumpAST") ) {
-                                            program->Print(0);
+                                            passes.Add(&printer);
+                                          }
+                                          if ( Trace::IsEnabled() ) {
+                                            passes.Add(&tracer);
                                           }
-                                          program->Check();
+                                          passes.Add(&resolver);
+                                          passes.Add(&checker);
+                                          PhaseTimer timer(Stats::CheckPhase);
+                                          TraceSpan span("check");
+                                          passes.Run(program);
                                       }
                                     }
           ;
@@ -178,13 +213,13 @@ Declaration : FuncDecl T_Semicolon   { $$ = $1; }
 
 FuncDecl  : TypeDecl T_Identifier T_LeftParen T_RightParen 
                          {
-                            Identifier *id = new Identifier(yylloc, (const char *)$2); 
+                            Identifier *id = new Identifier(yylloc, $2); 
                             List<VarDecl *> *formals = new List<VarDecl *>;
                             $$ = new FnDecl(id, $1, formals);
                          }
           | TypeDecl T_Identifier T_LeftParen ParameterList T_RightParen 
                          {
-                            Identifier *id = new Identifier(yylloc, (const char *)$2); 
+                            Identifier *id = new Identifier(yylloc, $2); 
                             $$ = new FnDecl(id, $1, $4);
                          }
           ;
@@ -195,34 +230,36 @@ ParameterList : SingleDecl { ($$ = new List<VarDecl *>)->Append($1);  }
 
 SingleDecl    : TypeDecl T_Identifier
                          {
-                            Identifier *id = new Identifier(yylloc, (const char *)$2); 
+                            Identifier *id = new Identifier(yylloc, $2); 
                             $$ = new VarDecl(id, $1);
                          }
               | TypeQualify TypeDecl T_Identifier
                          {
-                            Identifier *id = new Identifier(yylloc, (const char *)$3); 
+                            Identifier *id = new Identifier(yylloc, $3); 
                             $$ = new VarDecl(id, $2, $1);
                          }
               | TypeDecl T_Identifier T_Equal Initializer
                          {
                             // incomplete: drop the initializer here
-                            Identifier *id = new Identifier(yylloc, (const char *)$2); 
+                            Identifier *id = new Identifier(yylloc, $2); 
                             $$ = new VarDecl(id, $1, $4);
                          }
               | TypeQualify TypeDecl T_Identifier T_Equal Initializer
                          {
-                            Identifier *id = new Identifier(yylloc, (const char *)$3); 
+                            Identifier *id = new Identifier(yylloc, $3); 
                             $$ = new VarDecl(id, $2, $1, $5);
                          }
               | TypeDecl T_Identifier T_LeftBracket T_IntConstant T_RightBracket 
                          { 
-                            Identifier *id = new Identifier(@2, (const char *)$2);
-                            $$ = new VarDecl(id, new ArrayType(@1, $1, $4));
+                            Identifier *id = new Identifier(@2, $2);
+                            $$ = new VarDecl(id, ctx->types->ArrayOf($1, $4));
+                            $$->SetTypeLocation(@1);
                          }
               | TypeQualify TypeDecl T_Identifier T_LeftBracket T_IntConstant T_RightBracket 
                          { 
                             Identifier *id = new Identifier(@3, $3);
-                            $$ = new VarDecl(id, new ArrayType(@2, $2, $5), $1);
+                            $$ = new VarDecl(id, ctx->types->ArrayOf($2, $5), $1);
+                            $$->SetTypeLocation(@2);
                          }
 
               ;
@@ -308,7 +345,7 @@ ForStmt            : T_For T_LeftParen Expression T_Semicolon Expression T_Semic
                                  }
                    ;
 
-PrimaryExpr        : T_Identifier    { Identifier *id = new Identifier(yylloc, (const char*)$1);
+PrimaryExpr        : T_Identifier    { Identifier *id = new Identifier(yylloc, $1);
                                        $$ = new VarExpr(yyloc, id);
                                      }
                    | T_IntConstant   { $$ = new IntConstant(yylloc, $1); }
@@ -342,17 +379,17 @@ PostfixExpr        : PrimaryExpr     { $$ = $1; }
                                        }
                    | PostfixExpr T_Inc 
                                        {
-                                          Operator *op = new Operator(yylloc, (const char *)$2);
+                                          Operator *op = new Operator(yylloc, $2);
                                           $$ = new PostfixExpr($1, op);
                                        }
                    | PostfixExpr T_Dec 
                                        {
-                                          Operator *op = new Operator(yylloc, (const char *)$2);
+                                          Operator *op = new Operator(yylloc, $2);
                                           $$ = new PostfixExpr($1, op);
                                        }
                    | PostfixExpr T_Dot T_FieldSelection
                                        {
-                                          Identifier *id = new Identifier(yylloc, (const char *)$3);
+                                          Identifier *id = new Identifier(yylloc, $3);
                                           $$ = new FieldAccess($1, id);
                                        }
                    ;
@@ -470,10 +507,10 @@ Expression         : LogicOrExpr       { $$ = $1; }
                    ;
 
 AssignOp           : T_Equal         { $$ = new Operator(yylloc, $1);   }
-                   | T_AddAssign     { $$ = new Operator(yylloc, "+=");  }
-                   | T_SubAssign     { $$ = new Operator(yylloc, "-=");  }
-                   | T_MulAssign     { $$ = new Operator(yylloc, "*=");  }
-                   | T_DivAssign     { $$ = new Operator(yylloc, "/=");  }
+                   | T_AddAssign     { $$ = new Operator(yylloc, $1);   }
+                   | T_SubAssign     { $$ = new Operator(yylloc, $1);   }
+                   | T_MulAssign     { $$ = new Operator(yylloc, $1);   }
+                   | T_DivAssign     { $$ = new Operator(yylloc, $1);   }
                    ;
 
 %%
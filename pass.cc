@@ -0,0 +1,110 @@
+/* File: pass.cc
+ * -------------
+ * Implementation of the pass manager and the passes over the parse tree.
+ */
+
+#include <stdio.h>
+#include "pass.h"
+#include "ast_decl.h"
+#include "ast_expr.h"
+#include "trace.h"
+
+void PassManager::Run(Node *root, const char *label) {
+    Visit v = { root, NULL, 0, label, root->GetLocation() };
+    for (int first = 0; first < passes.size(); ) {
+        int last = first + 1;
+        if (!passes[first]->RunsAlone())
+            while (last < passes.size() && !passes[last]->RunsAlone())
+                last++;
+        Walk(v, first, last);
+        first = last;
+    }
+}
+
+/* Walks the tree under root with passes first to last-1. The children
+ * of the nodes along the path share one vector: each node adds its own
+ * at the end when it is entered and takes them off again when it is left.
+ */
+void PassManager::Walk(const Visit &root, int first, int last) {
+    Enter(root, first, last);
+    while (!path.empty()) {
+        Frame &f = path.back();
+        if (f.nextChild < f.endChildren) {
+            const Child &c = children[f.nextChild++];
+            Visit child = { c.node, f.visit.node, f.visit.depth + 1, c.label,
+                            c.location? c.location : c.node->GetLocation() };
+            Enter(child, first, last);
+            continue;
+        }
+        Visit v = f.visit;
+        children.resize(f.firstChild);
+        path.pop_back();
+        for (int i = last - 1; i >= first; i--)
+            passes[i]->Leave(v);
+    }
+}
+
+void PassManager::Enter(const Visit &v, int first, int last) {
+    for (int i = first; i < last; i++)
+        passes[i]->Enter(v);
+    int start = children.size();
+    v.node->GetChildren(&children);
+    Frame f = { v, start, start, (int)children.size() };
+    path.push_back(f);
+}
+
+void PrintPass::Enter(const Visit &v) {
+    const int numSpaces = 3;
+    Node *node = v.node;
+    printf("\n");
+    if (v.location)
+        printf("%*d", numSpaces, v.location->first_line);
+    else 
+        printf("%*s", numSpaces, "");
+    printf("%*s%s%s: ", (baseIndent + v.depth)*numSpaces, "", 
+           v.label? v.label : "", node->GetPrintNameForNode());
+    node->PrintChildren(baseIndent + v.depth);
+}
+
+// The printout of a whole program ends with a newline
+void PrintPass::Leave(const Visit &v) {
+    if (v.node->GetNodeKind() == ProgramNode)
+        printf("\n");
+}
+
+static bool IsTopLevelDecl(const Visit &v) {
+    nodeKindT kind = v.node->GetNodeKind();
+    return (kind == VarDeclNode || kind == FnDeclNode) &&
+           v.parent && v.parent->GetNodeKind() == ProgramNode;
+}
+
+void TracePass::Enter(const Visit &v) {
+    if (IsTopLevelDecl(v))
+        Trace::Begin("Decl::Check", ((Decl *)v.node)->GetIdentifier()->GetName());
+    if (v.node->GetNodeKind() == FnDeclNode)
+        Trace::Begin("FnDecl::CheckID", ((Decl *)v.node)->GetIdentifier()->GetName());
+}
+
+void TracePass::Leave(const Visit &v) {
+    if (v.node->GetNodeKind() == FnDeclNode)
+        Trace::End("FnDecl::CheckID");
+    if (IsTopLevelDecl(v))
+        Trace::End("Decl::Check");
+}
+
+void ResolvePass::Enter(const Visit &v) {
+    if (v.node->GetNodeKind() == VarExprNode)
+        ((VarExpr *)v.node)->Resolve();
+    else if (v.node->GetNodeKind() == CallNode)
+        ((Call *)v.node)->Resolve();
+}
+
+void CheckPass::Enter(const Visit &v) {
+    v.node->Check();
+}
+
+void CheckPass::Leave(const Visit &v) {
+    v.node->FinishCheck();
+    if (v.parent)
+        v.parent->ChildChecked(v.node);
+}
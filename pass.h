@@ -0,0 +1,121 @@
+/* File: pass.h
+ * ------------
+ * Passes over the parse tree. A pass says what to do when the walk
+ * enters a node, before any of its children, and when it leaves the
+ * node, after all of them; the PassManager does the walking, using
+ * GetChildren() to find the children of each node.
+ *
+ * Passes added to a PassManager run in the order they were added, and
+ * the manager fuses neighbouring passes: a single walk calls each of
+ * their Enter methods in order when it reaches a node and their Leave
+ * methods in the opposite order when it is done with it, so the passes
+ * nest like their calls would and the tree is only walked once. A pass
+ * whose work must not be interleaved with the others' is given a walk
+ * of its own.
+ *
+ * The walk does not recurse: the path from the root to the current node
+ * is kept on a stack on the heap, so a tree as deep as a long chain of
+ * operators in a generated shader does not overflow the call stack.
+ */
+
+#ifndef _H_pass
+#define _H_pass
+
+#include <vector>
+#include "ast.h"
+
+using namespace std;
+
+// Where the walk is: the node, its parent (NULL at the root), how far
+// the node is below the root, the label its parent gives it and where
+// it is in the source, if anywhere (see Child)
+struct Visit {
+    Node *node;
+    Node *parent;
+    int depth;
+    const char *label;
+    yyltype *location;
+};
+
+class Pass {
+  public:
+    virtual ~Pass() {}
+
+    virtual void Enter(const Visit &v) {}
+    virtual void Leave(const Visit &v) {}
+
+    // A pass that returns true is not fused with the passes before or
+    // after it: it walks the tree alone once the earlier passes are done
+    // with all of it, and the later ones start when it has finished
+    virtual bool RunsAlone() { return false; }
+};
+
+class PassManager {
+  protected:
+    struct Frame {
+        Visit visit;
+        int firstChild;         // where its children are in children
+        int nextChild;
+        int endChildren;
+    };
+
+    vector<Pass*> passes;
+    vector<Frame> path;         // the nodes from the root to the current one
+    vector<Child> children;     // children of the nodes on the path
+
+    void Walk(const Visit &root, int first, int last);
+    void Enter(const Visit &v, int first, int last);
+
+  public:
+    void Add(Pass *p) { passes.push_back(p); }
+    // Runs every pass over the tree under root, which is printed with label
+    void Run(Node *root, const char *label = NULL);
+};
+
+/* Prints a node per line: the line number the node starts on, if it has
+ * a location in the walk, then an indent of three spaces per level, the
+ * label, the print name of the node and, for leaves, what
+ * PrintChildren() prints.
+ * It runs alone, so the whole tree is printed before any diagnostic the
+ * checks report.
+ */
+class PrintPass : public Pass {
+  protected:
+    int baseIndent;
+
+  public:
+    PrintPass(int indentLevel = 0) : baseIndent(indentLevel) {}
+    void Enter(const Visit &v);
+    void Leave(const Visit &v);
+    bool RunsAlone() { return true; }
+};
+
+/* Records trace events around the checking of each declaration at the
+ * top level and of each function. Added ahead of the CheckPass, its
+ * events enclose all the checking done for the node.
+ */
+class TracePass : public Pass {
+  public:
+    void Enter(const Visit &v);
+    void Leave(const Visit &v);
+};
+
+/* Binds each VarExpr and Call to the declaration its name refers to,
+ * where it appears. It keeps no scopes of its own: it is added just
+ * ahead of the CheckPass, whose Check hooks declare names and open and
+ * close scopes as the shared walk goes, so the symbol table holds what
+ * is visible at each node when the node is entered.
+ */
+class ResolvePass : public Pass {
+  public:
+    void Enter(const Visit &v);
+};
+
+// Runs the semantic checks, through the Check hooks of each node
+class CheckPass : public Pass {
+  public:
+    void Enter(const Visit &v);
+    void Leave(const Visit &v);
+};
+
+#endif
@@ -9,15 +9,18 @@
 #define _H_scanner
 
 #include <stdio.h>
+#include "location.h"
 
 #define MaxIdentLen 31    // Maximum length for identifiers
 
-extern char *yytext;      // Text of lexeme just scanned
+class Context;
+union YYSTYPE;            // token values, generated into y.tab.h
 
+                          // Defined in the generated lex.yy.c file
+int yylex(union YYSTYPE *lvalp, yyltype *llocp, void *scanner);
 
-int yylex();              // Defined in the generated lex.yy.c file
+void InitScanner(Context *ctx);     // Defined in scanner.l user subroutines
+void DestroyScanner(Context *ctx);  // ditto
+int SetScannerSimd(int width);      // ditto
 
-void InitScanner();                 // Defined in scanner.l user subroutines
-const char *GetLineNumbered(int n); // ditto
- 
 #endif
@@ -0,0 +1,214 @@
+/* File: server.cc
+ * ---------------
+ * Implementation of the --serve mode.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "server.h"
+#include "context.h"
+#include "tokens.h"
+
+static const long MaxRequestLength = 64 * 1024 * 1024;
+
+static TokenCache *tokenCache = NULL;   // set up by Serve for --token-cache
+
+/* Function: JsonString()
+ * ----------------------
+ * Returns str as a quoted JSON string literal.
+ */
+static string JsonString(const string &str)
+{
+    string out = "\"";
+    for (int i = 0; i < str.size(); i++) {
+        unsigned char ch = str[i];
+        switch (ch) {
+          case '"':  out += "\\\""; break;
+          case '\\': out += "\\\\"; break;
+          case '\n': out += "\\n";  break;
+          case '\t': out += "\\t";  break;
+          case '\r': out += "\\r";  break;
+          default:
+            if (ch < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", ch);
+                out += buf;
+            } else
+                out += ch;
+        }
+    }
+    return out + "\"";
+}
+
+/* Function: CheckSource()
+ * -----------------------
+ * Checks one shader and returns the JSON response body for it.
+ */
+static string CheckSource(const string &source)
+{
+    Context ctx(source.data(), source.size(), NULL);
+    if (tokenCache)
+        tokenCache->Parse(&ctx);
+    else
+        ctx.Parse();
+
+    ostringstream body;
+    int errors = ctx.errors.NumErrors();
+    body << "{\"ok\":" << (errors == 0? "true" : "false")
+         << ",\"errors\":" << errors << ",\"diagnostics\":[";
+    for (int i = 0; i < ctx.errors.diagnostics.size(); i++) {
+        Diagnostic &d = ctx.errors.diagnostics[i];
+        body << (i > 0? "," : "")
+             << "{\"line\":" << d.line
+             << ",\"first_column\":" << d.firstColumn
+             << ",\"last_column\":" << d.lastColumn
+             << ",\"message\":" << JsonString(d.message) << "}";
+    }
+    body << "],\"output\":" << JsonString(ctx.errors.BufferedText()) << "}";
+    return body.str();
+}
+
+/* Function: ReadRequest()
+ * -----------------------
+ * Reads one framed request. Returns 1 on success, 0 at a clean end of
+ * input, and -1 (after describing the problem in *problem) if the
+ * header is malformed or the input ends partway through a request.
+ */
+static int ReadRequest(FILE *in, string *source, string *problem)
+{
+    char header[32];
+    if (!fgets(header, sizeof(header), in))
+        return 0;
+    char *end;
+    long length = strtol(header, &end, 10);
+    if (end == header || *end != '\n' || length < 0) {
+        *problem = "malformed request header";
+        return -1;
+    }
+    if (length > MaxRequestLength) {
+        *problem = "request too large";
+        return -1;
+    }
+    source->resize(length);
+    if (length > 0 && fread(&(*source)[0], 1, length, in) != length) {
+        *problem = "input ended inside a request";
+        return -1;
+    }
+    return 1;
+}
+
+static bool WriteResponse(FILE *out, const string &body)
+{
+    fprintf(out, "%d\n", (int)body.size());
+    fwrite(body.data(), 1, body.size(), out);
+    return fflush(out) == 0;
+}
+
+/* Function: ServeStream()
+ * -----------------------
+ * Answers requests read from in until the input ends.
+ */
+static void ServeStream(FILE *in, FILE *out)
+{
+    string source, problem;
+    int status;
+    while ((status = ReadRequest(in, &source, &problem)) > 0) {
+        if (!WriteResponse(out, CheckSource(source)))
+            return;
+    }
+    if (status < 0)
+        WriteResponse(out, "{\"error\":" + JsonString(problem) + "}");
+}
+
+/* Function: ServeConnection()
+ * ---------------------------
+ * Answers one client of the socket on the calling worker thread.
+ */
+static void ServeConnection(int fd)
+{
+    FILE *in = fdopen(fd, "r");
+    FILE *out = fdopen(dup(fd), "w");
+    if (in && out)
+        ServeStream(in, out);
+    if (in) fclose(in); else close(fd);
+    if (out) fclose(out);
+}
+
+/* Accepted connections waiting for a worker. The workers live as long
+ * as the server, so a new client costs no thread of its own and the
+ * number of threads stays fixed however many clients come and go. A
+ * client waits here while every worker is busy with another one.
+ */
+static mutex pendingLock;
+static condition_variable pendingReady;
+static deque<int> pending;
+
+static void ServeWorker()
+{
+    for (;;) {
+        int fd;
+        {
+            unique_lock<mutex> guard(pendingLock);
+            pendingReady.wait(guard, [] { return !pending.empty(); });
+            fd = pending.front();
+            pending.pop_front();
+        }
+        ServeConnection(fd);
+    }
+}
+
+static int ServeSocket(const char *path, int numWorkers)
+{
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return 2;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || listen(listener, 64) < 0) {
+        perror(path);
+        return 2;
+    }
+    for (int i = 0; i < numWorkers; i++)
+        thread(ServeWorker).detach();
+    for (;;) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0)
+            continue;
+        {
+            lock_guard<mutex> guard(pendingLock);
+            pending.push_back(fd);
+        }
+        pendingReady.notify_one();
+    }
+}
+
+int Serve(DriverOptions *options)
+{
+    signal(SIGPIPE, SIG_IGN); // a client going away is not our problem
+    if (options->tokenCacheDir)
+        tokenCache = new TokenCache(options->tokenCacheDir);
+    if (options->socketPath) {
+        int numWorkers = options->numThreads;
+        if (numWorkers == 0)
+            numWorkers = max(1, (int)thread::hardware_concurrency());
+        return ServeSocket(options->socketPath, numWorkers);
+    }
+    ServeStream(stdin, stdout);
+    return 0;
+}
@@ -0,0 +1,38 @@
+/* File: server.h
+ * --------------
+ * The --serve mode keeps one glc process running and checks shaders sent
+ * to it, so that editors and build tools do not pay for a new process on
+ * every check.
+ *
+ * Protocol: a request is the length of the source in bytes, written in
+ * decimal and followed by a newline, and then exactly that many bytes of
+ * shader source. Each response is framed the same way and its body is a
+ * JSON object such as
+ *
+ *    {"ok":false,"errors":1,
+ *     "diagnostics":[{"line":3,"first_column":9,"last_column":12,
+ *                     "message":"No declaration found for variable 'foo'"}],
+ *     "output":"\n*** Error line 3.\n..."}
+ *
+ * where output is the text glc would have printed to stderr. Responses
+ * come back in the order the requests were sent. A request header that
+ * cannot be read gets a {"error":...} response and ends the session.
+ *
+ * On a socket, clients are served by a fixed set of worker threads, so
+ * at most that many are answered at once and the others wait for a
+ * worker to come free.
+ *
+ * The server takes no -d flags, --trace or --stats-json: it never exits
+ * to write the files, and debug output would land in the responses.
+ */
+
+#ifndef _H_server
+#define _H_server
+
+#include "utility.h"
+
+// Serves requests on stdin/stdout, or on the Unix domain socket named by
+// options->socketPath. Returns the process exit status.
+int Serve(DriverOptions *options);
+
+#endif
@@ -0,0 +1,123 @@
+/* File: skip.h
+ * ------------
+ * Byte searches the scanner uses to get through blanks and comments
+ * many bytes at a time instead of one flex match per byte. Each returns
+ * the first position in [p, end) meeting its condition, or end, and
+ * never reads at or past end.
+ *
+ * The width says how many bytes they compare per step: 32 with AVX2,
+ * 16 with SSE2, or 0 to go a byte at a time throughout; the last few
+ * bytes are always done one at a time. SSE2 is part of every x86-64, so
+ * it is compiled in whenever the target has it. AVX2 is not, so the
+ * AVX2 loops are compiled for it on their own whatever the target, and
+ * are only used when SimdWidth() finds the CPU has it. Every width gives
+ * the same answer, which is what lets each be checked against the plain
+ * loops.
+ */
+
+#ifndef _H_skip
+#define _H_skip
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SKIP_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Returns the widest step the CPU running us can take: 32, 16 or 0
+static inline int SimdWidth()
+{
+#if defined(SKIP_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return 32;
+#endif
+#if defined(__SSE2__)
+    return 16;
+#else
+    return 0;
+#endif
+}
+
+static inline const char *FindByte(const char *p, const char *end,
+                                   char a, char b, char c, int width);
+static inline const char *SkipByte(const char *p, const char *end, char a, int width);
+
+#if defined(SKIP_AVX2)
+__attribute__((target("avx2")))
+static const char *FindByteAvx2(const char *p, const char *end, char a, char b, char c)
+{
+    const __m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b),
+                  vc = _mm256_set1_epi8(c);
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, va),
+                      _mm256_or_si256(_mm256_cmpeq_epi8(v, vb),
+                                      _mm256_cmpeq_epi8(v, vc)));
+        unsigned mask = _mm256_movemask_epi8(hit);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return FindByte(p, end, a, b, c, 16);
+}
+
+__attribute__((target("avx2")))
+static const char *SkipByteAvx2(const char *p, const char *end, char a)
+{
+    const __m256i va = _mm256_set1_epi8(a);
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, va));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return SkipByte(p, end, a, 16);
+}
+#endif
+
+// Returns the first byte equal to a, b or c
+static inline const char *FindByte(const char *p, const char *end,
+                                   char a, char b, char c, int width)
+{
+#if defined(SKIP_AVX2)
+    if (width >= 32) return FindByteAvx2(p, end, a, b, c);
+#endif
+#if defined(__SSE2__)
+    if (width >= 16) {
+        const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b),
+                      vc = _mm_set1_epi8(c);
+        for (; end - p >= 16; p += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)p);
+            __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, va),
+                          _mm_or_si128(_mm_cmpeq_epi8(v, vb),
+                                       _mm_cmpeq_epi8(v, vc)));
+            unsigned mask = _mm_movemask_epi8(hit);
+            if (mask) return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; p < end; p++)
+        if (*p == a || *p == b || *p == c) return p;
+    return end;
+}
+
+// Returns the first byte that is not a
+static inline const char *SkipByte(const char *p, const char *end, char a, int width)
+{
+#if defined(SKIP_AVX2)
+    if (width >= 32) return SkipByteAvx2(p, end, a);
+#endif
+#if defined(__SSE2__)
+    if (width >= 16) {
+        const __m128i va = _mm_set1_epi8(a);
+        for (; end - p >= 16; p += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)p);
+            unsigned mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(v, va)) & 0xffff;
+            if (mask) return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; p < end; p++)
+        if (*p != a) return p;
+    return end;
+}
+
+#endif
@@ -0,0 +1,71 @@
+/* File: stats.cc
+ * --------------
+ * Implementation of the phase timings and counters.
+ */
+
+#include "stats.h"
+
+bool Stats::enabled = false;
+Stats::Clock::duration Stats::clockCost = Stats::Clock::duration::zero();
+thread_local Stats *Stats::current = NULL;
+
+static const char *phaseNames[Stats::NumPhases] = {
+    "scan", "parse", "check"
+};
+
+static const char *counterNames[Stats::NumCounters] = {
+    "tokens", "nodes", "symbol_lookups", "scope_pushes", "diagnostics"
+};
+
+static double Milliseconds(Stats::Clock::duration d) {
+    return chrono::duration<double, milli>(d).count();
+}
+
+/* The cheapest of a few runs of back-to-back readings is taken, since a
+ * run that was interrupted only ever comes out slower.
+ */
+void Stats::Enable() {
+    const int readings = 1000;
+    for (int run = 0; run < 5; run++) {
+        Clock::time_point start = Clock::now(), end;
+        for (int i = 0; i < readings; i++)
+            end = Clock::now();
+        Clock::duration cost = (end - start) / readings;
+        if (run == 0 || cost < clockCost)
+            clockCost = cost;
+    }
+    enabled = true;
+}
+
+Stats::Stats() : units(0), scanCalls(0) {
+    for (int i = 0; i < NumPhases; i++)
+        times[i] = Clock::duration::zero();
+    for (int i = 0; i < NumCounters; i++)
+        counts[i] = 0;
+}
+
+void Stats::Add(const Stats &other) {
+    for (int i = 0; i < NumPhases; i++)
+        times[i] += other.times[i];
+    for (int i = 0; i < NumCounters; i++)
+        counts[i] += other.counts[i];
+    units += other.units;
+}
+
+void Stats::Print(FILE *fp) {
+    fprintf(fp, "+++ (stats): %d unit%s\n", units, units == 1? "" : "s");
+    for (int i = 0; i < NumPhases; i++)
+        fprintf(fp, "+++ (stats): %-16s %12.3f ms\n", phaseNames[i], Milliseconds(times[i]));
+    for (int i = 0; i < NumCounters; i++)
+        fprintf(fp, "+++ (stats): %-16s %12ld\n", counterNames[i], counts[i]);
+}
+
+void Stats::PrintJSON(FILE *fp) {
+    fprintf(fp, "{\"units\": %d, \"phases_ms\": {", units);
+    for (int i = 0; i < NumPhases; i++)
+        fprintf(fp, "%s\"%s\": %.3f", i? ", " : "", phaseNames[i], Milliseconds(times[i]));
+    fprintf(fp, "}, \"counts\": {");
+    for (int i = 0; i < NumCounters; i++)
+        fprintf(fp, "%s\"%s\": %ld", i? ", " : "", counterNames[i], counts[i]);
+    fprintf(fp, "}}\n");
+}
@@ -0,0 +1,112 @@
+/* File: stats.h
+ * -------------
+ * Instrumentation for finding out where glc spends its time: how long
+ * each phase takes and how much work it does. Each Context keeps its
+ * own Stats and makes them the current stats for its thread while it
+ * parses, so the code doing the work only has to call Stats::Count or
+ * start a PhaseTimer, and units checked on different threads never
+ * share counters. The driver adds up the stats of all the units.
+ *
+ * Nothing is recorded unless Stats::Enable() has been called, which the
+ * driver does for -d stats and --stats-json; otherwise Stats::current
+ * stays NULL and each hook costs a test and a branch.
+ *
+ * Scanning is timed around each call to yylex, and reading the clock
+ * costs about as much as finding a token. Enable() therefore measures
+ * what a reading costs, and each unit's times are corrected for the
+ * readings its ScanTimers made: one falls inside each timed call and
+ * is taken off the scan time, and the other falls outside it, in what
+ * would otherwise count as parsing. The times reported are then close
+ * to those of an untimed run, though the run itself is still slower by
+ * the cost of the readings.
+ */
+
+#ifndef _H_stats
+#define _H_stats
+
+#include <stdio.h>
+#include <chrono>
+
+using namespace std;
+
+class Stats {
+  public:
+    typedef enum {
+        ScanPhase,          // inside yylex, less the cost of timing it
+        ParsePhase,         // inside yyparse, less scanning and checking
+        CheckPhase,         // the passes run on the finished program
+        NumPhases
+    } phaseT;
+
+    typedef enum {
+        Tokens,
+        NodesAllocated,
+        SymbolLookups,
+        ScopePushes,
+        Diagnostics,
+        NumCounters
+    } counterT;
+
+    typedef chrono::steady_clock Clock;
+
+    Clock::duration times[NumPhases];
+    long counts[NumCounters];
+    int units;              // translation units the stats are for
+    long scanCalls;         // calls to yylex timed, for the correction
+
+    Stats();
+
+    // Adds other's times and counts to these
+    void Add(const Stats &other);
+
+    // What reading the clock cost each ScanTimer, on either side of the
+    // time it recorded
+    Clock::duration ScanTimingCost() const { return clockCost * scanCalls; }
+
+    // Writes the stats as text, for -d stats, or as a JSON object
+    void Print(FILE *fp);
+    void PrintJSON(FILE *fp);
+
+    // Turns recording on and measures clockCost; call before any threads
+    // start
+    static void Enable();
+    static bool IsEnabled()     { return enabled; }
+
+    // The stats work on this thread is recorded in, NULL if none
+    static Stats *Current()     { return current; }
+    // Makes s the current stats and returns the ones it replaces
+    static Stats *SetCurrent(Stats *s) { Stats *prev = current; current = s; return prev; }
+
+    static void Count(counterT c) { if (current) current->counts[c]++; }
+
+  protected:
+    static bool enabled;
+    static Clock::duration clockCost;   // of one reading of the clock
+    static thread_local Stats *current;
+};
+
+/* Adds the time from its construction to its destruction to a phase of
+ * the current stats, if there are any.
+ */
+class PhaseTimer {
+  protected:
+    Stats *stats;
+    Stats::phaseT phase;
+    Stats::Clock::time_point start;
+
+  public:
+    PhaseTimer(Stats::phaseT p) : stats(Stats::Current()), phase(p) {
+        if (stats) start = Stats::Clock::now();
+    }
+    ~PhaseTimer() {
+        if (stats) stats->times[phase] += Stats::Clock::now() - start;
+    }
+};
+
+// Times a call to yylex and counts it for the correction
+class ScanTimer : public PhaseTimer {
+  public:
+    ScanTimer() : PhaseTimer(Stats::ScanPhase) { if (stats) stats->scanCalls++; }
+};
+
+#endif
@@ -3,71 +3,162 @@
  *
  */
 
+#include <stdint.h>
 #include "symtable.h"
 #include "ast.h"
 #include "ast_type.h"
 #include "ast_decl.h"
+#include "ast_stmt.h"
+#include "stats.h"
 
-SymbolTable::SymbolTable(){
-  map<string, Decl*> s1;
+static const int InitialSlots = 64;     // must be a power of two
 
-  vector<scope> scopess;
-  scopes = scopess;
-  scopes.push_back(s1);
+SymbolTable::SymbolTable(){
+  Slot empty = { NULL, -1 };
+  slots.assign(InitialSlots, empty);
+  numKeys = 0;
+  scopeMarks.push_back(0);
+  numLoops = 0;
 
-  ifFlag = false;
-  elseFlag = false;
-  elifFlag = false;
-  whileFlag = false;
-  forFlag = false;
   globalScope = false;
   funcFlag = false;
-  doWhileFlag = false;
-  switchFlag = false;
-  breakFlag = false;
   returnFlag = false;
-  Type *returnType = NULL;
+  returnType = NULL;
 }
 
-void SymbolTable::pushScope(scope *s){
-  scopes.push_back(*s);
+//Atoms are unique pointers, so the pointer itself is hashed
+static inline unsigned HashAtom(Atom key){
+  uintptr_t p = (uintptr_t)key;
+  return (unsigned)((p >> 3) * 0x9e3779b1u);
 }
 
-void SymbolTable::popScope(){
-  scopes.pop_back();
+//Returns the slot for key, claiming an empty one if key is new.
+//Slots are never freed; a name with no visible binding keeps its slot.
+SymbolTable::Slot* SymbolTable::FindSlot(Atom key){
+  unsigned mask = slots.size() - 1;
+  for(unsigned i = HashAtom(key) & mask; ; i = (i + 1) & mask){
+    Slot *s = &slots[i];
+    if(s->key == key){
+      return s;
+    }
+    if(s->key == NULL){
+      if((numKeys + 1) * 2 > slots.size()){
+        Grow();
+        return FindSlot(key);
+      }
+      numKeys++;
+      s->key = key;
+      return s;
+    }
+  }
 }
 
-void SymbolTable::addSymbol(string key, Decl* decl){
-  scope* m = &scopes.back();
-  m->insert(pair<string,Decl*>(key,decl));
+//Returns the slot for key, or NULL if key has never been declared.
+//Unlike FindSlot it never changes the table, so lookups can use it.
+SymbolTable::Slot* SymbolTable::ProbeSlot(Atom key){
+  unsigned mask = slots.size() - 1;
+  for(unsigned i = HashAtom(key) & mask; ; i = (i + 1) & mask){
+    Slot *s = &slots[i];
+    if(s->key == key){
+      return s;
+    }
+    if(s->key == NULL){
+      return NULL;
+    }
+  }
 }
 
-Decl* SymbolTable::lookup(string key){
-  Decl* d = NULL;
-  for(vector<scope>::reverse_iterator vectorIt = scopes.rbegin(); vectorIt != scopes.rend(); ++vectorIt){
-    scope* s = &(*vectorIt);
-    d = lookupInScope(key, s);
-    if(d != NULL){
-      break;
+void SymbolTable::Grow(){
+  vector<Slot> old;
+  old.swap(slots);
+  Slot empty = { NULL, -1 };
+  slots.assign(old.size() * 2, empty);
+  unsigned mask = slots.size() - 1;
+  for(int j = 0; j < old.size(); j++){
+    if(old[j].key == NULL) continue;
+    unsigned i = HashAtom(old[j].key) & mask;
+    while(slots[i].key != NULL){
+      i = (i + 1) & mask;
     }
+    slots[i] = old[j];
   }
-  return d;
 }
 
-Decl* SymbolTable::lookupInScope(string key, scope *s){
-  int i = s->count(key);
-  if(i > 0){
-    return s->at(key);
+void SymbolTable::pushScope(){
+  Stats::Count(Stats::ScopePushes);
+  scopeMarks.push_back(bindings.size());
+}
+
+//Unwinds the bindings made since the scope was pushed, newest first,
+//uncovering whatever they shadowed. The outermost scope is never popped.
+void SymbolTable::popScope(){
+  if(scopeMarks.size() == 1){
+    return;
+  }
+  int mark = scopeMarks.back();
+  scopeMarks.pop_back();
+  while(bindings.size() > mark){
+    Binding &b = bindings.back();
+    FindSlot(b.key)->innermost = b.shadowed;
+    bindings.pop_back();
   }
-  return NULL;
 }
 
-scope* SymbolTable::currScope(){
-  if (&scopes.back() == NULL){
+//As before, a second declaration of a name in the same scope does not
+//replace the first.
+void SymbolTable::addSymbol(Atom key, Decl* decl){
+  Slot *s = FindSlot(key);
+  if(s->innermost >= 0 && bindings[s->innermost].depth == currScope()){
+    return;
   }
-  return &(scopes.back());
+  Binding b = { key, decl, currScope(), s->innermost };
+  s->innermost = bindings.size();
+  bindings.push_back(b);
+}
+
+Decl* SymbolTable::lookup(Atom key){
+  Stats::Count(Stats::SymbolLookups);
+  Slot *s = ProbeSlot(key);
+  if(s == NULL || s->innermost < 0){
+    return NULL;
+  }
+  return bindings[s->innermost].decl;
+}
+
+//Bindings along a chain are in decreasing depth, so the walk stops as
+//soon as it passes the scope asked about.
+Decl* SymbolTable::lookupInScope(Atom key, scope sc){
+  Stats::Count(Stats::SymbolLookups);
+  Slot *s = ProbeSlot(key);
+  if(s == NULL){
+    return NULL;
+  }
+  for(int i = s->innermost; i >= 0 && bindings[i].depth >= sc; i = bindings[i].shadowed){
+    if(bindings[i].depth == sc){
+      return bindings[i].decl;
+    }
+  }
+  return NULL;
+}
+
+scope SymbolTable::currScope(){
+  return scopeMarks.size() - 1;
 }
 
 int SymbolTable::size(){
-  return scopes.size();
+  return scopeMarks.size();
+}
+
+void SymbolTable::enterBreakable(Stmt *s){
+  breakTargets.push_back(s);
+  if(s->GetNodeKind() != SwitchNode){
+    numLoops++;
+  }
+}
+
+void SymbolTable::exitBreakable(){
+  if(breakTargets.back()->GetNodeKind() != SwitchNode){
+    numLoops--;
+  }
+  breakTargets.pop_back();
 }
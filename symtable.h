@@ -1,48 +1,77 @@
 /**
  * File: symtable.h
- * ----------- 
+ * -----------
  *  Header file for Symbol table implementation.
+ *
+ *  All scopes share one hash table from each name to its innermost
+ *  binding; a binding points to the binding it shadows, so the chain
+ *  for a name runs from the innermost scope outwards. Bindings live on
+ *  a stack in the order they were added, which doubles as the undo log:
+ *  a scope is just the stack height when it was pushed, and popping it
+ *  unlinks the bindings above that mark. Lookup is a single probe no
+ *  matter how deeply scopes are nested, and pushing a scope is free.
  */
 
 #ifndef _H_symtable
 #define _H_symtable
 
 #include <vector>
-#include <map>
-#include <string>
 #include "ast_decl.h"
+#include "atom.h"
 
 using namespace std;
-typedef map<string, Decl*> scope;
+typedef int scope;      // nesting depth of a scope, 0 is the outermost
 
 class SymbolTable {
   protected:
-    vector<scope> scopes;
+    struct Binding {
+        Atom key;
+        Decl *decl;
+        scope depth;
+        int shadowed;       // index of the binding it hides, or -1
+    };
+    struct Slot {
+        Atom key;           // NULL if the slot is empty
+        int innermost;      // index of the visible binding, or -1
+    };
+
+    vector<Binding> bindings;   // every live binding, outermost first
+    vector<int> scopeMarks;     // bindings.size() when each scope opened
+    vector<Slot> slots;         // open addressing, size is a power of two
+    int numKeys;
+
+    vector<Stmt*> breakTargets; // loops and switches being checked
+    int numLoops;               // how many of them are loops
+
+    Slot *FindSlot(Atom key);
+    Slot *ProbeSlot(Atom key);
+    void Grow();
 
   public:
     SymbolTable(); //constructor
 
-    bool ifFlag, elseFlag, elifFlag;
-    bool whileFlag, forFlag;
     bool globalScope;
     bool funcFlag;
-    bool doWhileFlag; 
-    bool switchFlag;
-    bool breakFlag;
     bool returnFlag;
     Type *returnType;
 
-    void pushScope(scope *s);
+    void pushScope();
     void popScope();
-    void addSymbol(string key, Decl* decl);
-    Decl* lookup(string key);
-    scope* currScope();
-    Decl* lookupInScope(string key, scope *s);
+    void addSymbol(Atom key, Decl* decl);
+    Decl* lookup(Atom key);
+    scope currScope();
+    Decl* lookupInScope(Atom key, scope s);
     int size();
-   
-};
 
+    //The loop or switch statement s is being checked until the matching
+    //exitBreakable. break is allowed inside any of them, continue only
+    //inside a loop.
+    void enterBreakable(Stmt *s);
+    void exitBreakable();
+    bool canBreak() { return !breakTargets.empty(); }
+    bool canContinue() { return numLoops > 0; }
 
-#endif
+};
 
 
+#endif
@@ -0,0 +1,57 @@
+/* File: threadpool.cc
+ * -------------------
+ * Implementation of the work-stealing thread pool.
+ */
+
+#include <thread>
+#include "threadpool.h"
+#include "utility.h"
+
+ThreadPool::ThreadPool(int n) : numThreads(n), queues(n) {
+    Assert(n > 0);
+}
+
+/* Items are dealt out round-robin so that every thread starts near the
+ * front of the list, which lets the driver print results in order as
+ * they finish instead of holding most of them until the end.
+ */
+void ThreadPool::ForEach(int count, const function<void(int)> &task) {
+    for (int i = 0; i < count; i++)
+        queues[i % numThreads].items.push_back(i);
+
+    vector<thread> threads;
+    for (int t = 1; t < numThreads; t++)
+        threads.push_back(thread(&ThreadPool::Work, this, t, cref(task)));
+    Work(0, task);
+    for (int t = 0; t < threads.size(); t++)
+        threads[t].join();
+}
+
+void ThreadPool::Work(int self, const function<void(int)> &task) {
+    int item;
+    while (Take(self, &item))
+        task(item);
+}
+
+/* Takes the next item from the thread's own queue, or failing that
+ * steals the last item of the first other queue that has one. No items
+ * are added once the threads start, so finding every queue empty means
+ * the work is done.
+ */
+bool ThreadPool::Take(int self, int *item) {
+    for (int k = 0; k < numThreads; k++) {
+        WorkQueue &q = queues[(self + k) % numThreads];
+        lock_guard<mutex> guard(q.lock);
+        if (q.items.empty())
+            continue;
+        if (k == 0) {
+            *item = q.items.front();
+            q.items.pop_front();
+        } else {
+            *item = q.items.back();
+            q.items.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,42 @@
+/* File: threadpool.h
+ * ------------------
+ * A small work-stealing thread pool used by the driver to check many
+ * translation units at once. Each thread starts with its own queue of
+ * work items and takes from the front of it; a thread whose queue runs
+ * dry steals from the back of another thread's queue, so a few large
+ * shaders landing on one thread do not leave the others idle.
+ */
+
+#ifndef _H_threadpool
+#define _H_threadpool
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+class ThreadPool {
+  protected:
+    struct WorkQueue {
+        mutex lock;
+        deque<int> items;
+    };
+
+    int numThreads;
+    vector<WorkQueue> queues;
+
+    bool Take(int self, int *item);
+    void Work(int self, const function<void(int)> &task);
+
+  public:
+    ThreadPool(int numThreads);
+
+    // Calls task(i) once for each i in [0, count), spread across the
+    // threads of the pool, and returns when every call has finished.
+    // The calling thread takes part as one of the workers.
+    void ForEach(int count, const function<void(int)> &task);
+};
+
+#endif
@@ -0,0 +1,327 @@
+/* File: tokens.cc
+ * ---------------
+ * Implementation of the token stream cache.
+ */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "tokens.h"
+#include "cache.h"
+#include "context.h"
+#include "parser.h"
+
+static const char StreamTag[] = "glc-tokens 1\n";
+static const int TagLength = sizeof(StreamTag) - 1;
+
+typedef enum {
+      NoValue,
+      AtomValue,
+      IntValue,
+      FloatValue,
+      BoolValue,
+      OpcodeValue
+} valueKindT;
+
+/* Which member of YYSTYPE the scanner sets for each token, as declared
+ * with %token in parser.y.
+ */
+static valueKindT ValueKind(int token)
+{
+    switch (token) {
+      case T_Identifier: case T_FieldSelection:
+        return AtomValue;
+      case T_IntConstant:
+        return IntValue;
+      case T_FloatConstant:
+        return FloatValue;
+      case T_BoolConstant:
+        return BoolValue;
+      case T_LessEqual: case T_GreaterEqual: case T_EQ: case T_NE:
+      case T_And: case T_Or: case T_Plus: case T_Star:
+      case T_MulAssign: case T_DivAssign: case T_AddAssign: case T_SubAssign:
+      case T_Equal: case T_LeftAngle: case T_RightAngle: case T_Dash:
+      case T_Slash: case T_Inc: case T_Dec:
+        return OpcodeValue;
+      default:
+        return NoValue;
+    }
+}
+
+static void PutVarint(string *out, uint64_t v)
+{
+    while (v >= 0x80) {
+        *out += (char)(v | 0x80);
+        v >>= 7;
+    }
+    *out += (char)v;
+}
+
+// Small negative numbers are kept short by interleaving them with the
+// positive ones
+static void PutSigned(string *out, int64_t v)
+{
+    PutVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+// Each returns false if the stream ends before the number does
+static inline bool GetVarint(const unsigned char *&p, const unsigned char *end, uint64_t *v)
+{
+    *v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char byte = *p++;
+        *v |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static inline bool GetSigned(const unsigned char *&p, const unsigned char *end, int64_t *v)
+{
+    uint64_t u;
+    if (!GetVarint(p, end, &u)) return false;
+    *v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+    return true;
+}
+
+
+/*** TokenRecorder ***/
+
+TokenRecorder::TokenRecorder() : numTokens(0), prevLine(0), complete(false), failed(false) {}
+
+void TokenRecorder::Add(int token, const YYSTYPE &value, const yyltype &loc, bool lexError)
+{
+    if (lexError) failed = true;
+    if (failed || complete) return;
+    PutVarint(&records, token);
+    PutSigned(&records, loc.first_line - prevLine);
+    PutSigned(&records, loc.first_column);
+    PutSigned(&records, loc.last_column - loc.first_column);
+    prevLine = loc.first_line;
+    switch (ValueKind(token)) {
+      case AtomValue: {
+        unordered_map<Atom, int>::iterator it = atomIds.find(value.atom);
+        int id;
+        if (it != atomIds.end()) {
+            id = it->second;
+        } else {
+            id = atoms.size();
+            atomIds[value.atom] = id;
+            atoms.push_back(value.atom);
+        }
+        PutVarint(&records, id);
+        break;
+      }
+      case IntValue:
+        PutSigned(&records, value.integerConstant);
+        break;
+      case FloatValue:
+        records.append((const char *)&value.floatConstant, sizeof(double));
+        break;
+      case BoolValue:
+        records += (char)value.boolConstant;
+        break;
+      case OpcodeValue:
+        records += (char)value.opcode;
+        break;
+      case NoValue:
+        break;
+    }
+    numTokens++;
+    if (token == 0) complete = true;
+}
+
+/* The tag is followed by a hash of everything after it, then the
+ * source length and the counts, the names and the token records.
+ */
+string TokenRecorder::Encode(int sourceLength) const
+{
+    string body;
+    PutVarint(&body, sourceLength);
+    PutVarint(&body, atoms.size());
+    PutVarint(&body, numTokens);
+    for (int i = 0; i < atoms.size(); i++) {
+        int length = strlen(atoms[i]);
+        PutVarint(&body, length);
+        body.append(atoms[i], length);
+    }
+    body += records;
+
+    uint64_t hash = HashBytes(body.data(), body.size());
+    string stream(StreamTag, TagLength);
+    stream.append((const char *)&hash, sizeof(hash));
+    return stream + body;
+}
+
+
+/*** TokenReader ***/
+
+bool TokenReader::Open(const char *data, size_t size, Context *c)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    end = p + size;
+    if (size < TagLength + sizeof(uint64_t) || memcmp(p, StreamTag, TagLength) != 0)
+        return false;
+    p += TagLength;
+    uint64_t hash;
+    memcpy(&hash, p, sizeof(hash));
+    p += sizeof(hash);
+    if (HashBytes(p, end - p) != hash)
+        return false;
+
+    uint64_t sourceLength, numAtoms, numTokens;
+    if (!GetVarint(p, end, &sourceLength) || !GetVarint(p, end, &numAtoms)
+        || !GetVarint(p, end, &numTokens))
+        return false;
+    if (sourceLength != c->sourceLength || numAtoms > (uint64_t)(end - p))
+        return false;
+    vector<const unsigned char *> names(numAtoms);
+    vector<int> lengths(numAtoms);
+    for (int i = 0; i < numAtoms; i++) {
+        uint64_t length;
+        if (!GetVarint(p, end, &length) || length > (uint64_t)(end - p)) return false;
+        names[i] = p;
+        lengths[i] = length;
+        p += length;
+    }
+
+    const char *source = c->source.data();
+    lineStarts.assign(1, 0);
+    for (const char *nl = source; (nl = (const char *)memchr(nl, '\n', source + c->sourceLength - nl)); nl++)
+        lineStarts.push_back(nl + 1 - source);
+    numNames = numAtoms;
+
+    // Every record is checked before the parser sees any of them, since
+    // the source can only be scanned instead while nothing has been parsed
+    next = p;
+    loc.first_line = 0;
+    int token;
+    YYSTYPE value;
+    do {
+        if (!Read(&token, &value)) return false;
+    } while (token != 0);
+    if (next != end) return false;
+
+    ctx = c;
+    next = p;
+    loc.first_line = 0;
+    atoms.resize(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+        atoms[i] = ctx->atoms.Intern((const char *)names[i], lengths[i]);
+    return true;
+}
+
+/* Reads the record at next into *token, *value and loc. Returns false if
+ * the stream ends partway through it or it holds something the scanner
+ * could not have returned: an unknown token, a line outside the source,
+ * or a value out of range for the token.
+ */
+bool TokenReader::Read(int *token, YYSTYPE *value)
+{
+    uint64_t code;
+    int64_t line, column, width;
+    if (!GetVarint(next, end, &code) || !GetSigned(next, end, &line)
+        || !GetSigned(next, end, &column) || !GetSigned(next, end, &width))
+        return false;
+    if (code != 0 && (code < T_Void || code > T_FieldSelection))
+        return false;
+    *token = code;
+    line += loc.first_line;
+    if (line < 0 || line > lineStarts.size())
+        return false;
+    loc.first_line = line;
+    loc.first_column = column;
+    loc.last_column = column + width;
+    switch (ValueKind(*token)) {
+      case AtomValue: {
+        uint64_t id;
+        if (!GetVarint(next, end, &id) || id >= numNames) return false;
+        value->atom = (id < atoms.size())? atoms[id] : NULL;   // none yet while checking
+        break;
+      }
+      case IntValue: {
+        int64_t v;
+        if (!GetSigned(next, end, &v)) return false;
+        value->integerConstant = v;
+        break;
+      }
+      case FloatValue:
+        if (end - next < sizeof(double)) return false;
+        memcpy(&value->floatConstant, next, sizeof(double));
+        next += sizeof(double);
+        break;
+      case BoolValue:
+        if (next >= end || *next > 1) return false;
+        value->boolConstant = *next++;
+        break;
+      case OpcodeValue:
+        if (next >= end || *next >= NumOpcodes) return false;
+        value->opcode = (opcodeT)*next++;
+        break;
+      case NoValue:
+        break;
+    }
+    return true;
+}
+
+/* The scanner records the start of each line as it passes the newline
+ * before it, so the lines up to the token just returned are known to
+ * the Context, and all of them once the end is reached.
+ */
+int TokenReader::Next(YYSTYPE *value, yyltype *l)
+{
+    int token;
+    if (next >= end || !Read(&token, value)) return 0;
+    l->first_line = loc.first_line;
+    l->first_column = loc.first_column;
+    l->last_column = loc.last_column;
+
+    int lines = (token == 0)? lineStarts.size() : loc.first_line;
+    while (ctx->lineStarts.size() < lines && ctx->lineStarts.size() < lineStarts.size())
+        ctx->lineStarts.push_back(lineStarts[ctx->lineStarts.size()]);
+    return token;
+}
+
+
+/*** TokenCache ***/
+
+TokenCache::TokenCache(const char *d) : dir(d) {
+    versionHash = ExecutableHash();
+    mkdir(dir.c_str(), 0777);
+}
+
+int TokenCache::Parse(Context *ctx)
+{
+    uint64_t key = HashBytes(ctx->source.data(), ctx->sourceLength, versionHash);
+    int fd = open(CacheEntryPath(dir, key, ".tokens", false).c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        void *map = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+            map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map != MAP_FAILED) {
+            TokenReader reader;
+            bool usable = reader.Open((const char *)map, st.st_size, ctx);
+            int result = 0;
+            if (usable) {
+                ctx->tokenReader = &reader;
+                result = ctx->Parse();
+                ctx->tokenReader = NULL;
+            }
+            munmap(map, st.st_size);
+            if (usable) return result;
+        }
+    }
+
+    TokenRecorder recorder;
+    ctx->tokenRecorder = &recorder;
+    int result = ctx->Parse();
+    ctx->tokenRecorder = NULL;
+    if (recorder.IsUsable())
+        WriteFileAtomically(CacheEntryPath(dir, key, ".tokens", true),
+                            recorder.Encode(ctx->sourceLength));
+    return result;
+}
@@ -0,0 +1,115 @@
+/* File: tokens.h
+ * --------------
+ * A binary cache of token streams, enabled with --token-cache, for
+ * sources that are parsed over and over, such as one shader checked with
+ * many different driver options. The first parse of a source scans it
+ * as usual and records every token yylex hands the parser. Later parses
+ * of the same source map the recorded stream and feed the parser from
+ * it, so flex never runs.
+ *
+ * A stream holds the names of the identifiers once each, in the order
+ * they were first seen, then one record per token: its kind, its
+ * location packed as varints relative to the token before, and its
+ * value, which is an atom ID, a constant or an opcode depending on the
+ * kind. The last record is the end of input, along with the location
+ * the scanner left at that point, which is where a syntax error at the
+ * end is reported. The line starts the scanner would have recorded are
+ * found again from the source, which is needed anyway to print the
+ * context of diagnostics.
+ *
+ * Only a complete, clean scan is stored: if the scanner reported an
+ * error, or the parse stopped before the end of the input, the source
+ * is simply scanned again next time. Streams are addressed like results
+ * in cache.h, by the source and the glc executable, and are checked
+ * against a hash of their contents before use. The hash only catches
+ * accidental damage, so every record is also checked to hold what the
+ * scanner could have returned before the parser sees any of them; a
+ * stream that fails is ignored and the source is scanned.
+ */
+
+#ifndef _H_tokens
+#define _H_tokens
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "location.h"
+#include "atom.h"
+
+using namespace std;
+
+class Context;
+union YYSTYPE;
+
+/* Class: TokenRecorder
+ * --------------------
+ * Encodes the tokens of a scan as they are returned. The scan is usable
+ * once it has seen the end of input without a lexical error.
+ */
+class TokenRecorder {
+  protected:
+    vector<Atom> atoms;
+    unordered_map<Atom, int> atomIds;
+    string records;
+    int numTokens;
+    int prevLine;
+    bool complete, failed;
+
+  public:
+    TokenRecorder();
+
+    // Records token, with the value and location yylex returned it with.
+    // lexError is set if the scanner reported an error while finding it.
+    void Add(int token, const YYSTYPE &value, const yyltype &loc, bool lexError);
+    bool IsUsable() const { return complete && !failed; }
+
+    // The encoded stream for a source of the given length
+    string Encode(int sourceLength) const;
+};
+
+/* Class: TokenReader
+ * ------------------
+ * Replays an encoded stream for the alternate yylex. The stream must
+ * stay mapped while it is read.
+ */
+class TokenReader {
+  protected:
+    Context *ctx;
+    const unsigned char *next, *end;
+    int numNames;
+    vector<Atom> atoms;         // the names, once the stream is checked
+    vector<int> lineStarts;     // of the whole source
+    yyltype loc;                // of the previous token
+
+    bool Read(int *token, YYSTYPE *value);
+
+  public:
+    // Checks data, down to every record, as a stream for ctx's source and
+    // interns its names in ctx. Returns false, leaving ctx untouched, if
+    // it is not usable, so that the source can be scanned instead.
+    bool Open(const char *data, size_t size, Context *ctx);
+
+    // Returns the next token as yylex does, without scanning
+    int Next(YYSTYPE *value, yyltype *loc);
+};
+
+/* Class: TokenCache
+ * -----------------
+ * The directory of stored streams.
+ */
+class TokenCache {
+  protected:
+    string dir;
+    uint64_t versionHash;   // hash of the glc executable
+
+  public:
+    TokenCache(const char *dir);
+
+    // Parses ctx from its stored token stream if there is a usable one,
+    // and otherwise scans it, storing the stream for next time. Returns
+    // Context::Parse's result.
+    int Parse(Context *ctx);
+};
+
+#endif
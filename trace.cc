@@ -0,0 +1,91 @@
+/* File: trace.cc
+ * --------------
+ * Implementation of the per-thread trace buffers.
+ */
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "trace.h"
+
+typedef chrono::steady_clock Clock;
+
+struct TraceEvent {
+    const char *name;
+    string detail;
+    char phase;             // 'B' or 'E'
+    Clock::time_point time;
+    const char *argName;    // of a time argument, or NULL
+    Clock::duration argValue;
+};
+
+struct TraceBuffer {
+    vector<TraceEvent> events;
+    int tid;
+    TraceBuffer *next;      // the buffer of the thread that started before
+};
+
+bool Trace::enabled = false;
+
+static const Clock::time_point traceStart = Clock::now();
+static atomic<TraceBuffer*> buffers(NULL);
+static atomic<int> nextTid(1);
+static thread_local TraceBuffer *threadBuffer = NULL;
+
+static TraceBuffer *ThreadBuffer() {
+    if (threadBuffer == NULL) {
+        TraceBuffer *b = new TraceBuffer;
+        b->tid = nextTid++;
+        b->next = buffers.load();
+        while (!buffers.compare_exchange_weak(b->next, b))
+            ;
+        threadBuffer = b;
+    }
+    return threadBuffer;
+}
+
+void Trace::Record(const char *name, const char *detail, char phase) {
+    TraceBuffer *b = ThreadBuffer();
+    b->events.push_back(TraceEvent());
+    TraceEvent &e = b->events.back();
+    e.name = name;
+    if (detail) e.detail = detail;
+    e.phase = phase;
+    e.time = Clock::now();
+    e.argName = NULL;
+}
+
+void Trace::End(const char *name, const char *argName, Clock::duration value) {
+    if (!enabled) return;
+    Record(name, NULL, 'E');
+    TraceEvent &e = ThreadBuffer()->events.back();
+    e.argName = argName;
+    e.argValue = value;
+}
+
+// Event names are literals and details are identifiers, so neither
+// needs escaping in JSON
+bool Trace::Write(const char *fileName) {
+    FILE *fp = fopen(fileName, "w");
+    if (!fp) return false;
+    fprintf(fp, "{\"traceEvents\": [");
+    const char *separator = "\n";
+    for (TraceBuffer *b = buffers.load(); b != NULL; b = b->next) {
+        for (int i = 0; i < b->events.size(); i++) {
+            TraceEvent &e = b->events[i];
+            double us = chrono::duration<double, micro>(e.time - traceStart).count();
+            fprintf(fp, "%s{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": %d",
+                    separator, e.name, e.phase, us, b->tid);
+            if (!e.detail.empty())
+                fprintf(fp, ", \"args\": {\"name\": \"%s\"}", e.detail.c_str());
+            else if (e.argName)
+                fprintf(fp, ", \"args\": {\"%s\": %.3f}", e.argName,
+                        chrono::duration<double, milli>(e.argValue).count());
+            fprintf(fp, "}");
+            separator = ",\n";
+        }
+    }
+    fprintf(fp, "\n], \"displayTimeUnit\": \"ms\"}\n");
+    return fclose(fp) == 0;
+}
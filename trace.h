@@ -0,0 +1,67 @@
+/* File: trace.h
+ * -------------
+ * Records what glc is doing over time as begin/end events, written out
+ * at the end of the run in the Chrome trace-event format for --trace, so
+ * that chrome://tracing or Perfetto can show which phases and which
+ * functions take the time.
+ *
+ * Scanning happens a token at a time all through the parse, and an
+ * event per token would be far more than the trace could hold or the
+ * scanner could afford. The time the unit's scanning took in all, as
+ * the stats time it, is put instead on the end of its parse event as
+ * the lex_ms argument, which the viewers show with the parse.
+ *
+ * Every thread records into a buffer of its own, so recording an event
+ * takes no lock and touches nothing shared. A thread's buffer is made
+ * the first time it records an event and is linked onto a global list
+ * with a compare-and-swap; the buffers outlive their threads and are
+ * only read once all the checking threads are done.
+ *
+ * Nothing is recorded unless Trace::Enable() was called before any
+ * thread started, so the hooks cost a single test when tracing is off.
+ */
+
+#ifndef _H_trace
+#define _H_trace
+
+#include <string>
+#include <chrono>
+
+using namespace std;
+
+class Trace {
+  public:
+    static void Enable()        { enabled = true; }
+    static bool IsEnabled()     { return enabled; }
+
+    // name must be a string literal; detail, if given, is copied and
+    // shown as the name argument of the event
+    static void Begin(const char *name, const char *detail = NULL)
+        { if (enabled) Record(name, detail, 'B'); }
+    static void End(const char *name)
+        { if (enabled) Record(name, NULL, 'E'); }
+    // Records an end event with the given time as the argument argName,
+    // in milliseconds; both names must be string literals
+    static void End(const char *name, const char *argName,
+                    chrono::steady_clock::duration value);
+
+    // Writes the events of every thread to fileName; returns false if
+    // the file cannot be written
+    static bool Write(const char *fileName);
+
+  protected:
+    static bool enabled;
+    static void Record(const char *name, const char *detail, char phase);
+};
+
+/* Records a begin event when it is made and the matching end event when
+ * it goes out of scope.
+ */
+class TraceSpan {
+    const char *name;
+  public:
+    TraceSpan(const char *n, const char *detail = NULL) : name(n) { Trace::Begin(n, detail); }
+    ~TraceSpan() { Trace::End(name); }
+};
+
+#endif
@@ -58,19 +58,100 @@ void PrintDebug(const char *key, const char *format, ...) {
   printf("+++ (%s): %s%s", key, buf, buf[strlen(buf)-1] != '\n'? "\n" : "");
 }
 
-void ParseCommandLine(int argc, char *argv[]) {
-  if (argc == 1)
-    return;
-  
-  if (strcmp(argv[1], "-d") != 0) { // first arg is not -d
-    printf("Incorrect Use:   ");
-    for (int i = 1; i < argc; i++) printf("%s ", argv[i]);
-    printf("\n");
-    printf("Correct Usage:   -d <debug-key-1> <debug-key-2> ... \n");
+bool ReadWholeFile(FILE *fp, std::string *contents) {
+  char buf[64 * 1024];
+  size_t n;
+  contents->clear();
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    contents->append(buf, n);
+  return !ferror(fp);
+}
+
+static void Usage(int argc, char *argv[]) {
+  printf("Incorrect Use:   ");
+  for (int i = 1; i < argc; i++) printf("%s ", argv[i]);
+  printf("\n");
+  printf("Correct Usage:   [-j <threads>] [--cache-dir <dir>] [--token-cache <dir>] "
+         "[--stats-json <file>] [--trace <file>] [--files-from <list>] [<file> ...] "
+         "[-d <debug-key-1> <debug-key-2> ...] \n");
+  printf("                 --serve [--socket <path> [-j <threads>]] [--token-cache <dir>]\n");
+  exit(2);
+}
+
+// Appends each non-blank line of the list file as an input file name
+static void ReadFileList(const char *listName, DriverOptions *options) {
+  FILE *fp = fopen(listName, "r");
+  if (!fp) {
+    printf("Cannot open file list %s\n", listName);
     exit(2);
   }
+  char line[BufferSize];
+  while (fgets(line, sizeof(line), fp)) {
+    int len = strlen(line);
+    while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r'))
+      line[--len] = '\0';
+    if (len > 0)
+      options->inputFiles.push_back(strdup(line));
+  }
+  fclose(fp);
+}
+
+void ParseCommandLine(int argc, char *argv[], DriverOptions *options) {
+  int i;
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-d") == 0)
+      break;
+    if (strcmp(argv[i], "--files-from") == 0) {
+      if (++i == argc) Usage(argc, argv);
+      ReadFileList(argv[i], options);
+    } else if (strcmp(argv[i], "--cache-dir") == 0) {
+      if (++i == argc) Usage(argc, argv);
+      options->cacheDir = argv[i];
+    } else if (strcmp(argv[i], "--stats-json") == 0) {
+      if (++i == argc) Usage(argc, argv);
+      options->statsFile = argv[i];
+    } else if (strcmp(argv[i], "--trace") == 0) {
+      if (++i == argc) Usage(argc, argv);
+      options->traceFile = argv[i];
+    } else if (strcmp(argv[i], "--token-cache") == 0) {
+      if (++i == argc) Usage(argc, argv);
+      options->tokenCacheDir = argv[i];
+    } else if (strcmp(argv[i], "--serve") == 0) {
+      options->serve = true;
+    } else if (strcmp(argv[i], "--socket") == 0) {
+      if (++i == argc) Usage(argc, argv);
+      options->serve = true;
+      options->socketPath = argv[i];
+    } else if (strncmp(argv[i], "-j", 2) == 0) {
+      const char *count = argv[i] + 2;     // accept both -j4 and -j 4
+      if (*count == '\0') {
+        if (++i == argc) Usage(argc, argv);
+        count = argv[i];
+      }
+      char *end;
+      options->numThreads = strtol(count, &end, 10);
+      if (*end != '\0' || options->numThreads < 1) Usage(argc, argv);
+    } else if (argv[i][0] == '-') {
+      Usage(argc, argv);
+    } else {
+      options->inputFiles.push_back(argv[i]);
+    }
+  }
+
+  // The server runs until it is killed, so it would never write a trace
+  // or stats file while they grew, and debug output on stdout would be
+  // mixed into its responses
+  if (options->serve && (!options->inputFiles.empty() || options->statsFile ||
+                         options->traceFile || i < argc))
+    Usage(argc, argv);
+
+  // Debug output is not cached, and a file whose result comes from the
+  // cache is never parsed, so would be missing from the stats and the
+  // trace; results are computed afresh whenever any of them is asked for
+  if (i < argc || options->statsFile || options->traceFile)
+    options->cacheDir = NULL;
 
-  for (int i = 2; i < argc; i++)
+  for (i = i + 1; i < argc; i++)
     SetDebugForKey(argv[i], true);
 }
 
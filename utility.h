@@ -9,6 +9,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <vector>
+#include <string>
 
 /**
  * Function: Failure()
@@ -73,14 +75,64 @@ void SetDebugForKey(const char *key, bool val);
 
 bool IsDebugOn(const char *key);
 
+/**
+ * Function: ReadWholeFile()
+ * Usage: if (ReadWholeFile(fp, &source)) ...
+ * ------------------------------------------
+ * Reads everything remaining in fp into contents. Returns false if a
+ * read error occurs.
+ */
+
+bool ReadWholeFile(FILE *fp, std::string *contents);
+
+/**
+ * Struct: DriverOptions
+ * ---------------------
+ * Settings gathered from the command line that control what the driver
+ * in main.cc does:
+ *   inputFiles     shaders to check; if empty, one is read from stdin
+ *   numThreads     files checked, or clients served, at once; 0 if no -j
+ *   serve          answer requests as described in server.h instead
+ *   socketPath     Unix domain socket to serve on, or NULL for stdin
+ *   cacheDir       result cache directory (see cache.h), or NULL
+ *   statsFile      where to write the stats as JSON (see stats.h), or NULL
+ *   traceFile      where to write the trace events (see trace.h), or NULL
+ *   tokenCacheDir  token stream cache directory (see tokens.h), or NULL
+ */
+
+struct DriverOptions {
+  std::vector<const char*> inputFiles;
+  int numThreads;
+  bool serve;
+  const char *socketPath;
+  const char *cacheDir;
+  const char *statsFile;
+  const char *traceFile;
+  const char *tokenCacheDir;
+
+  DriverOptions() : numThreads(0), serve(false), socketPath(NULL), cacheDir(NULL),
+                    statsFile(NULL), traceFile(NULL), tokenCacheDir(NULL) {}
+};
+
 /**
  * Function: ParseCommandLine
  * --------------------------
- * Turn on the debugging flags from the command line.  Verifies that
- * first argument is -d, and then interpret all the arguments that follow
- * as being flags to turn on.
+ * Collect the shader files to check and turn on the debugging flags from
+ * the command line:
+ *   <file> ...             shaders to check
+ *   --files-from <list>    shaders to check, one per line of list
+ *   -j <n>                 check up to n files, or serve n clients, at once
+ *   --cache-dir <dir>      reuse results stored by earlier runs
+ *   --stats-json <file>    write the stats of the run, as -d stats prints them
+ *   --trace <file>         write a trace in Chrome's trace-event format
+ *   --token-cache <dir>    parse sources seen before from their stored tokens
+ *   --serve                start the server instead of checking files
+ *   --socket <path>        serve on a socket rather than stdin/stdout
+ *   -d <key> ...           turn on every debugging flag that follows
+ * The server takes no files, -d, --trace or --stats-json, and any of the
+ * last three turn the result cache off.
  */
 
-void ParseCommandLine(int argc, char *argv[]);
+void ParseCommandLine(int argc, char *argv[], DriverOptions *options);
      
 #endif